@@ -0,0 +1,329 @@
+//==============================================================================
+// Date        : 10/16/26 (agent)
+// Description : Generates a synthetic GeoFLOW dataset (x,y,z grid files and
+//               field variable files for each timestep) along with a JSON file
+//               to convert it. The element count, polynomial order, number of
+//               element layers, variables and timesteps are configurable, for
+//               both spherical and box grids. Elements of the different
+//               element layers are interleaved in the files, as in GeoFLOW
+//               output, and the 2D mesh layers at element layer boundaries are
+//               duplicated.
+// Copyright   : Copyright 2021. Regents of the University of Colorado.
+//               All rights reserved.
+//==============================================================================
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <sys/stat.h>
+
+#include "gtypes.h"
+#include "pt_util.h"
+
+using namespace std;
+
+// Options of the dataset to generate
+struct GenOptions
+{
+    GString outDir;        // directory to write the dataset to
+    GString templateFile;  // JSON file the generated JSON file is based on
+    GUINT dim;             // dimension of elements (2 or 3)
+    GSIZET elemsPerLayer;  // num elements per element layer
+    GUINT elemLayers;      // num element layers (1 for a 2D dataset)
+    GUINT polyOrder;       // poly order of each ref dir
+    GUINT numVars;         // num field variables
+    GUINT numTimesteps;    // num timesteps of each field variable
+    GBOOL isSpherical;     // spherical grid if true, box grid otherwise
+    GBOOL isFloat;         // single precision values if true, double otherwise
+};
+
+void usage(const char* prog)
+{
+    cerr << "Usage: " << prog << " <OUTPUT_DIR> [options]\n"
+         << "  --dim <2|3>              dimension of elements (default 3)\n"
+         << "  --elems-per-layer <n>    elements per element layer "
+            "(default 384)\n"
+         << "  --elem-layers <n>        element layers (default 4; 1 if 2D)\n"
+         << "  --poly-order <n>         poly order of each ref dir "
+            "(default 4)\n"
+         << "  --vars <n>               field variables (default 2)\n"
+         << "  --timesteps <n>          timesteps per variable (default 2)\n"
+         << "  --box                    box grid instead of a spherical one\n"
+         << "  --float                  single precision (float) values "
+            "instead of double\n"
+         << "  --template <json>        JSON file to base the generated JSON "
+            "file on\n"
+         << "                           (default test-data/ugrid-3D.json, or "
+            "test-data/ugrid-box.json with --box)"
+         << endl;
+}
+
+GenOptions parseCommandLine(int argc, char** argv)
+{
+    if (argc < 2 || argv[1][0] == '-')
+    {
+        usage(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    GenOptions o = {argv[1], "", 3, 384, 4, 4, 2, 2, true, false};
+    for (int i = 2; i < argc; ++i)
+    {
+        GString arg = argv[i];
+        if (arg == "--box")
+        {
+            o.isSpherical = false;
+            continue;
+        }
+        if (arg == "--float")
+        {
+            o.isFloat = true;
+            continue;
+        }
+        if (i + 1 >= argc)
+        {
+            usage(argv[0]);
+            exit(EXIT_FAILURE);
+        }
+        GString val = argv[++i];
+        if (arg == "--dim")                  { o.dim = stoul(val); }
+        else if (arg == "--elems-per-layer") { o.elemsPerLayer = stoull(val); }
+        else if (arg == "--elem-layers")     { o.elemLayers = stoul(val); }
+        else if (arg == "--poly-order")      { o.polyOrder = stoul(val); }
+        else if (arg == "--vars")            { o.numVars = stoul(val); }
+        else if (arg == "--timesteps")       { o.numTimesteps = stoul(val); }
+        else if (arg == "--template")        { o.templateFile = val; }
+        else
+        {
+            usage(argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if (o.dim != 2 && o.dim != 3)
+    {
+        cerr << "Error: --dim must be 2 or 3" << endl;
+        exit(EXIT_FAILURE);
+    }
+    if (o.dim == 2)
+    {
+        o.elemLayers = 1;
+    }
+    if (o.templateFile.empty())
+    {
+        o.templateFile = o.isSpherical ? "test-data/ugrid-3D.json"
+                                       : "test-data/ugrid-box.json";
+    }
+    return o;
+}
+
+/*!
+ * Write a GeoFLOW file: the header in the layout GFileReader::readHeader
+ * reads, followed by the data values (as float or double).
+ */
+void writeGFFile(const GString& filename, const GenOptions& o,
+                 const vector<GSIZET>& elemIDs, GSIZET timeCycle,
+                 GDOUBLE timeStamp, const vector<GDOUBLE>& data)
+{
+    ofstream ofs(filename, ios::out | ios::binary);
+    if (!ofs)
+    {
+        cerr << "Error: Cannot open file: " << filename << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    GUINT version = 1;
+    GSIZET nElems = elemIDs.size();
+    GUINT gridType = o.isSpherical ? GE_2DEMBEDDED : GE_REGULAR;
+    if (o.dim == 3)
+    {
+        gridType = o.isSpherical ? GE_DEFORMED : GE_REGULAR;
+    }
+    GUINT hasMultVars = 0;
+
+    ofs.write((const char*)&version, sizeof(version));
+    ofs.write((const char*)&o.dim, sizeof(o.dim));
+    ofs.write((const char*)&nElems, sizeof(nElems));
+    for (GUINT d = 0; d < o.dim; ++d)
+    {
+        ofs.write((const char*)&o.polyOrder, sizeof(o.polyOrder));
+    }
+    ofs.write((const char*)&gridType, sizeof(gridType));
+    ofs.write((const char*)&timeCycle, sizeof(timeCycle));
+    ofs.write((const char*)&timeStamp, sizeof(timeStamp));
+    ofs.write((const char*)&hasMultVars, sizeof(hasMultVars));
+    ofs.write((const char*)elemIDs.data(), nElems * sizeof(GSIZET));
+    if (o.isFloat)
+    {
+        vector<GFLOAT> values(data.begin(), data.end());
+        ofs.write((const char*)values.data(), values.size() * sizeof(GFLOAT));
+    }
+    else
+    {
+        ofs.write((const char*)data.data(), data.size() * sizeof(GDOUBLE));
+    }
+
+    if (!ofs)
+    {
+        cerr << "Error: Cannot write file: " << filename << endl;
+        exit(EXIT_FAILURE);
+    }
+    cout << "Wrote: " << filename << endl;
+}
+
+/*!
+ * Write the JSON file used to convert the generated dataset, based on a
+ * template JSON file. The template's first field variable definition is
+ * copied for each generated field variable.
+ */
+void writeJSON(const GenOptions& o, const vector<GString>& varNames)
+{
+    pt::ptree root;
+    PTUtil::readJSONFile(o.templateFile, root);
+
+    root.put("dataset_description", "Synthetic GeoFLOW dataset.");
+    root.put("input_dir", o.outDir);
+    root.put("output_dir", o.outDir + "/output");
+    root.put("num_timesteps", o.numTimesteps);
+    root.put("is_spherical", o.isSpherical);
+    root.put("write_profile", true);
+    root.put("data_type", o.isFloat ? "GFLOAT" : "GDOUBLE");
+    root.put("grid_filenames.x", "xgrid.000000.out");
+    root.put("grid_filenames.y", "ygrid.000000.out");
+    root.put("grid_filenames.z", "zgrid.000000.out");
+
+    // Use the template's first field variable as the definition of every
+    // generated field variable
+    pt::ptree tmplNames = PTUtil::getArray(root, "field_variable_root_names");
+    GString tmplName = tmplNames.begin()->second.data();
+    pt::ptree& varArr = PTUtil::getArrayRef(root, "variables");
+    pt::ptree tmplVar;
+    for (auto& v : varArr)
+    {
+        if (v.second.get<GString>("name") == tmplName) { tmplVar = v.second; }
+    }
+
+    pt::ptree names;
+    for (const auto& n : varNames)
+    {
+        pt::ptree name;
+        name.put("", n);
+        names.push_back(make_pair("", name));
+
+        pt::ptree var = tmplVar;
+        var.put("name", n);
+        varArr.push_back(make_pair("", var));
+    }
+    root.put_child("field_variable_root_names", names);
+
+    GString filename = o.outDir + "/ugrid.json";
+    pt::write_json(filename, root);
+    cout << "Wrote: " << filename << endl;
+}
+
+int main(int argc, char** argv)
+{
+    GenOptions o = parseCommandLine(argc, argv);
+    if (mkdir(o.outDir.c_str(), 0777) != 0 && errno != EEXIST)
+    {
+        cerr << "Error: Cannot create directory (" << o.outDir << "): "
+             << strerror(errno) << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    // Lay each element layer's elements out on an nA x nB grid of patches
+    GSIZET nA = o.elemsPerLayer;
+    GSIZET nB = 1;
+    for (GSIZET b = 1; b * b <= o.elemsPerLayer; ++b)
+    {
+        if (o.elemsPerLayer % b == 0) { nB = b; }
+    }
+    nA = o.elemsPerLayer / nB;
+
+    GSIZET n = o.polyOrder + 1;               // num nodes per ref dir
+    GSIZET nZ = (o.dim == 3) ? n : 1;         // num nodes in z ref dir
+    GSIZET nNodesPerElem = n * n * nZ;
+    GSIZET nElems = o.elemsPerLayer * o.elemLayers;
+    GSIZET nNodes = nElems * nNodesPerElem;
+    cout << "Generating " << nElems << " elements (" << nNodes << " nodes) "
+         << "per file" << endl;
+
+    // Element layers are interleaved in the files: file element e belongs
+    // to element layer e % elemLayers, which is also its element ID.
+    vector<GSIZET> elemIDs(nElems);
+    vector<GDOUBLE> x(nNodes), y(nNodes), z(nNodes);
+    const GDOUBLE pi = 4.0 * atan(1.0);
+    GSIZET i = 0;
+    for (GSIZET e = 0; e < nElems; ++e)
+    {
+        GSIZET layer = e % o.elemLayers;
+        GSIZET j = e / o.elemLayers; // element within its layer
+        GSIZET a = j % nA;
+        GSIZET b = j / nA;
+        elemIDs[e] = layer;
+
+        // Nodes are ordered by z level, then x ref dir, then y ref dir
+        for (GSIZET k = 0; k < nZ; ++k)
+        {
+            // Heights at the top of one element layer and the bottom of the
+            // next are identical
+            GDOUBLE h = (nZ > 1) ? (layer + GDOUBLE(k) / (nZ - 1))
+                                   / o.elemLayers : 0;
+            for (GSIZET u = 0; u < n; ++u)
+            {
+                for (GSIZET w = 0; w < n; ++w, ++i)
+                {
+                    GDOUBLE s = (a + GDOUBLE(u) / o.polyOrder) / nA;
+                    GDOUBLE t = (b + GDOUBLE(w) / o.polyOrder) / nB;
+                    if (o.isSpherical)
+                    {
+                        GDOUBLE lon = 2 * pi * s;
+                        GDOUBLE lat = (t - 0.5) * pi * 160 / 180;
+                        GDOUBLE r = 6.371e6 + 1.0e4 * h;
+                        x[i] = r * cos(lat) * cos(lon);
+                        y[i] = r * cos(lat) * sin(lon);
+                        z[i] = r * sin(lat);
+                    }
+                    else
+                    {
+                        x[i] = 1.0e4 * s;
+                        y[i] = 1.0e4 * t;
+                        z[i] = 1.0e3 * h;
+                    }
+                }
+            }
+        }
+    }
+
+    writeGFFile(o.outDir + "/xgrid.000000.out", o, elemIDs, 0, 0, x);
+    writeGFFile(o.outDir + "/ygrid.000000.out", o, elemIDs, 0, 0, y);
+    writeGFFile(o.outDir + "/zgrid.000000.out", o, elemIDs, 0, 0, z);
+
+    // Field values are a smooth function of position, so duplicated nodes
+    // get identical values
+    vector<GString> varNames;
+    vector<GDOUBLE> f(nNodes);
+    for (GUINT v = 0; v < o.numVars; ++v)
+    {
+        varNames.push_back("var" + to_string(v));
+        for (GUINT ts = 0; ts < o.numTimesteps; ++ts)
+        {
+            for (GSIZET m = 0; m < nNodes; ++m)
+            {
+                f[m] = sin((v + 1) * x[m] * 1.0e-6) * cos(y[m] * 1.0e-6)
+                       + (ts + 1) * z[m] * 1.0e-7;
+            }
+
+            char timestep[16];
+            snprintf(timestep, sizeof(timestep), "%06u", ts);
+            writeGFFile(o.outDir + "/" + varNames.back() + "." + timestep +
+                        ".out", o, elemIDs, ts, 60.0 * ts, f);
+        }
+    }
+
+    writeJSON(o, varNames);
+    return 0;
+}
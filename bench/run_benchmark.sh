@@ -0,0 +1,56 @@
+#!/bin/bash
+#==============================================================================
+# Date        : 10/16/26 (agent)
+# Description : Generates synthetic GeoFLOW datasets of increasing size with
+#               bin/gen_data, converts each one with bin/main (write_profile
+#               on) and prints the wall time and throughput (items/s, MB/s) of
+#               each pipeline stage.
+#               Usage: bench/run_benchmark.sh [SIZE...]
+#               SIZE is small, medium or large (default: small medium). Set
+#               BENCH_DIR to choose where datasets are written (default
+#               bench-data), BENCH_ARGS to pass more options to gen_data (i.e.,
+#               --box) and BENCH_JSON to add keys to the generated JSON (i.e.,
+#               '"reorder_by_permutation": true').
+# Copyright   : Copyright 2021. Regents of the University of Colorado.
+#               All rights reserved.
+#==============================================================================
+
+set -e
+
+BENCH_DIR=${BENCH_DIR:-bench-data}
+SIZES=${@:-small medium}
+
+mkdir -p "$BENCH_DIR"
+
+for size in $SIZES; do
+    # Elements per layer, element layers, variables, timesteps (poly order 4)
+    case $size in
+        small)  opts="--elems-per-layer 384 --elem-layers 4 --vars 2" ;;
+        medium) opts="--elems-per-layer 1536 --elem-layers 8 --vars 2" ;;
+        large)  opts="--elems-per-layer 6144 --elem-layers 16 --vars 4" ;;
+        *) echo "Unknown size: $size (use small, medium or large)"; exit 1 ;;
+    esac
+
+    dir="$BENCH_DIR/$size"
+    rm -rf "$dir"
+    opts="$opts --poly-order 4 --timesteps 4 $BENCH_ARGS"
+    ./bin/gen_data "$dir" $opts > /dev/null
+
+    # Add the requested keys to the generated JSON file
+    json="$dir/ugrid.json"
+    if [ -n "$BENCH_JSON" ]; then
+        sed -i "0,/{/s//{\n    $BENCH_JSON,/" "$json"
+    fi
+
+    ./bin/main "$json" > "$dir/main.log"
+
+    echo "=== $size ($opts)"
+    printf "%-24s %12s %16s %12s\n" "stage" "wall (s)" "items/s" "MB/s"
+    sed -n 's/.*"name": "\([^"]*\)".*"wall_time_s": \([^,]*\),.*'\
+'"items_per_s": \([^,]*\), "mb_per_s": \([^}]*\)}.*/\1 \2 \3 \4/p' \
+        "$dir/output/profile.json" |
+    while read name wall items mb; do
+        printf "%-24s %12.4f %16.0f %12.1f\n" "$name" "$wall" "$items" "$mb"
+    done
+    echo
+done
@@ -2,8 +2,9 @@
 // Date        : 4/5/21 (SG)
 // Description : Writes GeoFLOW data to a NetCDF file. An input JSON property 
 //               tree with dimensions, variable definitions and attributes is 
-//               used to to write the NetCDF variable metadata. A collection of 
-//               nodes or other data types are used to write data values. 
+//               compiled into a schema that is used to write the NetCDF 
+//               variable metadata. A collection of nodes or other data types 
+//               are used to write data values. 
 // Copyright   : Copyright 2021. Regents of the University of Colorado. 
 //               All rights reserved.
 //==============================================================================
@@ -13,23 +14,30 @@
 
 #include <map>
 #include <vector>
+#include <algorithm>
+#include <type_traits>
 #include <netcdf>
 
 #include "gtypes.h"
-#include "pt_util.h"
-#include "gnode.h"
+#include "gschema.h"
+#include "logger.h"
 
 using namespace std;
 using namespace netCDF;
 using namespace netCDF::exceptions;
 
+// Max bytes of converted values (i.e., double values written to a float
+// variable) held at a time; more mesh layers are converted in blocks
+#define G_MAX_CONVERT_BYTES (16 * 1024 * 1024)
+
 class GToNetCDF
 {
 public:
     /*!
      * Initialize the GeoFLOW to NetCDF file writer.
      * 
-     * @param ptRoot root of a property tree with metadata; file format is JSON
+     * @param schema dimensions and variables compiled from the JSON property 
+     *               tree (must outlive the writer)
      * @param ncFilename name of NetCDF file to write to with file extension 
      *                   (ex. myfile.nc)
      * @param mode NcFile::FileMode::read (file exists, open read-only), 
@@ -38,12 +46,21 @@ public:
      *             exists), 
      *             NcFile::FileMode::newFile (create new file, fail if already 
      *             exists)
+     *
+     * With NcFile::FileMode::replace, the file is written under a temporary 
+     * name (ncFilename.tmp) and renamed to ncFilename when the writer is 
+     * destroyed, so an interrupted conversion never leaves a partial file 
+     * under the final name.
      */
-    GToNetCDF(pt::ptree& ptRoot,
+    GToNetCDF(const GSchema& schema,
               const GString& ncFilename,
               NcFile::FileMode mode);
 
-    ~GToNetCDF() {}
+    /*!
+     * Close the NetCDF file, and rename it to its final name if it was 
+     * written under a temporary name.
+     */
+    ~GToNetCDF();
 
     /*!
      * Convert a GeoFLOW data type to a NetCDF NcType.
@@ -77,16 +94,14 @@ public:
     NcType getVariableType(const GString& varName);
 
     /*!
-     * Read the "dimensions" array in the property tree and write each 
-     * dimension object to the NetCDF file. A dimension gets written in the 
-     * form: dimName = dimValue
+     * Write each dimension of the schema to the NetCDF file. A dimension 
+     * gets written in the form: dimName = dimValue
      */
     void writeDimensions();
 
     /*!
-     * Iterate the "variables" array in the property tree and look for the 
-     * varName variable object. Write the variable's defintion to the NetCDF 
-     * file. A variable gets written in the form: 
+     * Write the definition of the varName variable of the schema to the 
+     * NetCDF file. A variable gets written in the form: 
      * varType varName(dim1, dim2, ...)
      *
      * @param varName name of variable
@@ -94,9 +109,26 @@ public:
     void writeVariableDefinition(const GString& varName);
 
     /*!
-     * Read the "attributes" array of the varName variable object in the 
-     * "variables" array of the property tree and write the variable's 
-     * attributes to the NetCDF file. An attribute gets written in the form: 
+     * Write the definition of a variable of the schema to the NetCDF file.
+     *
+     * @param handle handle of the variable in the schema
+     */
+    void writeVariableDefinition(GUINT handle);
+
+    /*!
+     * Set the NetCDF-4 storage settings (chunk shape, shuffle and deflate 
+     * filters, and lossy quantization) of a newly defined variable. The 
+     * default chunk shape is one meshLayers/time slice by the full size of 
+     * every other dimension. Scalar variables are left unchanged.
+     *
+     * @param ncVar the NetCDF variable that was just defined
+     * @param var the variable in the schema
+     */
+    void writeVariableStorage(const NcVar& ncVar, const GSchemaVariable& var);
+
+    /*!
+     * Write the attributes of the varName variable of the schema to the 
+     * NetCDF file. An attribute gets written in the form: 
      * varName:attrName = "attrValue"
      *
      * @param varName name of variable
@@ -104,108 +136,293 @@ public:
     void writeVariableAttributes(const GString& varName);
 
     /*!
-     * Write varName's data stored in nodes to the NetCDF file.
+     * Write the attributes of a variable of the schema to the NetCDF file.
+     *
+     * @param handle handle of the variable in the schema
+     */
+    void writeVariableAttributes(GUINT handle);
+
+    /*!
+     * Get the number of values a variable holds (the product of its 
+     * dimension sizes, or 1 for a scalar variable).
      *
-     * @param rootVarName name of a variable in the NetCDF file
-     * @param fullVarName name of the variable (i.e., rootVarName.timestep) in 
-     *                    the list of nodes 
-     * @param nodes list of nodes that contains the variable data to write
+     * @param ncVar a NetCDF variable
+     * @return the number of values
+     */
+    GSIZET getVariableSize(const NcVar& ncVar);
+
+    /*!
+     * Write varName's single-valued data to the NetCDF file.
+     *
+     * @param varName name of a variable in the NetCDF file
+     * @param varValue value of the variable data to write
      */
-    /*template <typename T>
-    void writeVariableData(const GString& rootVarName, 
-                           const GString& fullVarName,
-                           const vector<GNode<T>>& nodes)*/
     template <typename T>
-    void writeVariableData(const GString& rootVarName, 
-                           GUINT varNameIndex,
-                           const vector<GNode<T>>& nodes)
+    void writeVariableData(const GString& varName,
+                           const T& varValue)
     {
-        Logger::info(__FILE__, __FUNCTION__, "");
-        cout << "Writing NetCDF variable data from nodes for variable: "
-             << rootVarName << " at at var index: " << varNameIndex << endl;
+        Logger::info(__FILE__, __FUNCTION__, "Writing NetCDF variable data " \
+                     "from single-value for variable: " + varName);
 
+        writeVariableData(varName, &varValue, 1);
+    }
+
+    /*!
+     * Write varName's data stored in values to the NetCDF file.
+     *
+     * @param varName name of a variable in the NetCDF file
+     * @param values vector of values that contains the variable data to write
+     */
+    template <typename T>
+    void writeVariableData(const GString& varName,
+                           const vector<T>& values)
+    {
+        Logger::info(__FILE__, __FUNCTION__, "Writing NetCDF variable data " \
+                     "from a list of values for variable: " + varName);
+
+        writeVariableData(varName, values.data(), values.size());
+    }
+
+    /*!
+     * Write varName's data from a contiguous buffer to the NetCDF file. The 
+     * buffer is passed straight to the NetCDF library (no copy is made). If 
+     * the buffer holds more values than the variable, only the leading 
+     * values are written.
+     *
+     * @param varName name of a variable in the NetCDF file
+     * @param data address of the first value to write
+     * @param size number of values in data
+     */
+    template <typename T>
+    void writeVariableData(const GString& varName,
+                           const T* data,
+                           GSIZET size)
+    {
         // Get the NcVar associated with this variable
-        NcVar ncVar = _nc.getVar(rootVarName);
+        NcVar ncVar = _nc.getVar(varName);
 
-        // Allocate memory and fill values
-        T *data = new T[nodes.size()];
-        for (auto i = 0u; i < nodes.size(); ++i)
+        // Make sure the buffer covers the whole variable
+        GSIZET varSize = getVariableSize(ncVar);
+        if (size < varSize)
         {
-            data[i] = nodes[i].var(varNameIndex);
+            std::string msg = "The number of values to write (" + \
+                              to_string(size) + ") is less than the size " \
+                              "of variable (" + varName + ") in the NetCDF " \
+                              "file (" + to_string(varSize) + ").";
+            Logger::error(__FILE__, __FUNCTION__, msg);
+            exit(EXIT_FAILURE);
         }
 
         // Write the data to the NetCDF file
         ncVar.putVar(data);
-
-        // Clean memory
-        delete [] data;
-        data = 0;
     }
 
     /*!
-     * Write varName's single-valued data to the NetCDF file.
+     * Write a strided hyperslab of varName's data from a contiguous buffer 
+     * to the NetCDF file. The buffer is passed straight to the NetCDF 
+     * library (no copy is made) and holds the product of count values.
      *
      * @param varName name of a variable in the NetCDF file
-     * @param varValue value of the variable data to write
+     * @param data address of the first value to write
+     * @param start index of the first value written along each dimension
+     * @param count number of values written along each dimension
+     * @param stride step between values written along each dimension (empty 
+     *               for a step of 1 along every dimension)
      */
     template <typename T>
     void writeVariableData(const GString& varName,
-                           const T& varValue)
+                           const T* data,
+                           const vector<GSIZET>& start,
+                           const vector<GSIZET>& count,
+                           const vector<ptrdiff_t>& stride = 
+                               vector<ptrdiff_t>())
     {
-        Logger::info(__FILE__, __FUNCTION__, "");
-        cout << "Writing NetCDF variable data from single-value for variable: "
-             << varName << endl;
-
         // Get the NcVar associated with this variable
         NcVar ncVar = _nc.getVar(varName);
 
-        // Allocate memory and fill value
-        T *data = new T[1];
-        data[0] = varValue;
-
         // Write the data to the NetCDF file
-        ncVar.putVar(data);
-
-        // Clean memory
-        delete [] data;
-        data = 0;
+        if (stride.empty())
+        {
+            ncVar.putVar(start, count, data);
+        }
+        else
+        {
+            ncVar.putVar(start, count, stride, data);
+        }
     }
 
     /*!
-     * Write varName's data stored in values to the NetCDF file.
+     * Write varName's data to the NetCDF file a few 2D mesh layers at a 
+     * time with hyperslab writes, so the values only need to be available 
+     * one group of layers at a time. Each group is requested from produce, 
+     * which is called as produce(firstLayer, numLayers) and returns the 
+     * address of numLayers * layerSize contiguous values that stay valid 
+     * until the next call. Variables with fewer than 2 dimensions (i.e., no 
+     * mesh layer dimension) are written from the first layer only.
      *
      * @param varName name of a variable in the NetCDF file
-     * @param values vector of values that contains the variable data to write
+     * @param numLayers number of 2D mesh layers to write
+     * @param layerSize number of values per 2D mesh layer
+     * @param layersPerWrite max number of layers per write (0 for all)
+     * @param produce provider of the values of a group of layers
      */
-    template <typename T>
-    void writeVariableData(const GString& varName,
-                           const vector<T>& values)
+    template <typename T, typename F>
+    void writeVariableLayers(const GString& varName,
+                             GSIZET numLayers,
+                             GSIZET layerSize,
+                             GSIZET layersPerWrite,
+                             F produce)
     {
-        Logger::info(__FILE__, __FUNCTION__, "");
-        cout << "Writing NetCDF variable data from a list of values for "
-             << "variable: " << varName << endl;
+        Logger::info(__FILE__, __FUNCTION__, "Writing NetCDF variable data by " \
+                     "mesh layer for variable: " + varName);
 
         // Get the NcVar associated with this variable
         NcVar ncVar = _nc.getVar(varName);
+        GSIZET nDims = ncVar.getDimCount();
+        if (nDims < 2)
+        {
+            if (getVariableSize(ncVar) > layerSize)
+            {
+                std::string msg = "The number of values to write (" + \
+                                  to_string(layerSize) + ") is less than " \
+                                  "the size of variable (" + varName + ") " \
+                                  "in the NetCDF file.";
+                Logger::error(__FILE__, __FUNCTION__, msg);
+                exit(EXIT_FAILURE);
+            }
+            putValues(ncVar, produce(0, 1), layerSize, vector<GSIZET>(), 
+                      vector<GSIZET>());
+            return;
+        }
 
-        // Allocate memory and fill values
-        T *data = new T[values.size()];
-        for (auto i = 0u; i < values.size(); ++i)
+        // The last two dimensions are (meshLayers, nMeshNodes); any leading 
+        // dimension (i.e., time) has a single entry
+        if (ncVar.getDim(nDims - 2).getSize() != numLayers ||
+            ncVar.getDim(nDims - 1).getSize() != layerSize)
         {
-            data[i] = values[i];
+            std::string msg = "The mesh layer dimensions of variable (" + \
+                              varName + ") are different than the number " \
+                              "of layers (" + to_string(numLayers) + ") " \
+                              "and layer size (" + to_string(layerSize) + \
+                              ") to write.";
+            Logger::error(__FILE__, __FUNCTION__, msg);
+            exit(EXIT_FAILURE);
         }
 
-        // Write the data to the NetCDF file
-        ncVar.putVar(data);
+        if (layersPerWrite == 0 || layersPerWrite > numLayers)
+        {
+            layersPerWrite = numLayers;
+        }
+
+        vector<GSIZET> start(nDims, 0);
+        vector<GSIZET> count(nDims, 1);
+        count[nDims - 1] = layerSize;
 
-        // Clean memory
-        delete [] data;
-        data = 0;
+        // For each group of mesh layers...
+        for (GSIZET l = 0; l < numLayers; l += layersPerWrite)
+        {
+            GSIZET n = std::min(layersPerWrite, numLayers - l);
+            start[nDims - 2] = l;
+            count[nDims - 2] = n;
+            putValues(ncVar, produce(l, n), n * layerSize, start, count);
+        }
     }
 
 private:
-    pt::ptree _ptRoot; // root of the property tree
-    NcFile _nc;        // NetCDF file handle
+    /*!
+     * Write values to a NetCDF variable, converting them to the variable's 
+     * type first when it is float and the values are double (or the other 
+     * way around). The conversion is done here in blocks of whole mesh 
+     * layers of at most G_MAX_CONVERT_BYTES, whatever the number of layers 
+     * per write, so writing i.e., double values to a float variable needs 
+     * no full-size copy of the data and halves the bytes passed to the 
+     * library.
+     *
+     * @param ncVar the NetCDF variable
+     * @param data address of the first value to write
+     * @param size number of values in data
+     * @param start index of the first value written along each dimension 
+     *              (empty to write the whole variable)
+     * @param count number of values written along each dimension
+     */
+    template <typename T>
+    void putValues(const NcVar& ncVar,
+                   const T* data,
+                   GSIZET size,
+                   const vector<GSIZET>& start,
+                   const vector<GSIZET>& count)
+    {
+        NcType ncType = ncVar.getType();
+        if (ncType == ncFloat && !std::is_same<T, GFLOAT>::value)
+        {
+            putConverted<GFLOAT>(ncVar, data, size, start, count);
+        }
+        else if (ncType == ncDouble && !std::is_same<T, GDOUBLE>::value)
+        {
+            putConverted<GDOUBLE>(ncVar, data, size, start, count);
+        }
+        else if (start.empty())
+        {
+            ncVar.putVar(data);
+        }
+        else
+        {
+            ncVar.putVar(start, count, data);
+        }
+    }
+
+    /*!
+     * Convert values to type U and write them to a NetCDF variable, a block
+     * of mesh layers at a time. Values written without a hyperslab (a 
+     * variable with no mesh layer dimension) are converted at once.
+     *
+     * @param ncVar the NetCDF variable
+     * @param data address of the first value to write
+     * @param size number of values in data
+     * @param start index of the first value written along each dimension 
+     *              (empty to write the whole variable)
+     * @param count number of values written along each dimension
+     */
+    template <typename U, typename T>
+    void putConverted(const NcVar& ncVar,
+                      const T* data,
+                      GSIZET size,
+                      const vector<GSIZET>& start,
+                      const vector<GSIZET>& count)
+    {
+        if (start.empty() || count.size() < 2 || size == 0)
+        {
+            vector<U> values(data, data + size);
+            putValues(ncVar, values.data(), size, start, count);
+            return;
+        }
+
+        // The last two dimensions are (meshLayers, nMeshNodes)
+        GSIZET nDims = count.size();
+        GSIZET numLayers = count[nDims - 2];
+        GSIZET layerSize = size / numLayers;
+        GSIZET layersPerBlock = std::max<GSIZET>(1, G_MAX_CONVERT_BYTES / 
+                                                 (layerSize * sizeof(U)));
+        layersPerBlock = std::min(layersPerBlock, numLayers);
+
+        vector<U> values(layersPerBlock * layerSize);
+        vector<GSIZET> blockStart(start);
+        vector<GSIZET> blockCount(count);
+        for (GSIZET l = 0; l < numLayers; l += layersPerBlock)
+        {
+            GSIZET n = std::min(layersPerBlock, numLayers - l);
+            std::copy(data + l * layerSize, data + (l + n) * layerSize, 
+                      values.begin());
+            blockStart[nDims - 2] = start[nDims - 2] + l;
+            blockCount[nDims - 2] = n;
+            ncVar.putVar(blockStart, blockCount, values.data());
+        }
+    }
+
+    const GSchema& _schema; // dimensions and variables to write
+    NcFile _nc;             // NetCDF file handle
+    GString _filename;      // final name of the NetCDF file
+    GString _tmpFilename;   // name written to until closed (empty if none)
 };
 
 #endif
\ No newline at end of file
@@ -10,15 +10,24 @@
 #define GCONVERTER_H
 
 #include <vector>
+#include <set>
+#include <memory>
+#include <unordered_map>
 
 #include "gheader_info.h"
-#include "gnode.h"
-#include "gface.h"
+#include "gspan.h"
+#include "gnode_store.h"
 #include "g_to_netcdf.h"
+#include "gschema.h"
+#include "ggrid_cache.h"
 #include "pt_util.h"
 
 using namespace std;
 
+// Num nodes per face (quadrilaterals); each face takes this many entries in 
+// the face connectivity buffer
+#define G_FACE_NODES 4
+
 template <class T>
 class GDataConverter
 {
@@ -43,10 +52,32 @@ public:
     GBOOL is_spherical() const;
     GBOOL do_print_nodes() const;
     GBOOL do_write_separate_var_files() const;
+    GBOOL do_reorder_by_permutation() const;
+    GBOOL do_stream_timesteps() const;
+    GBOOL do_use_mmap_reader() const;
+    GUINT numReadThreads() const;
+    GBOOL do_remove_duplicate_layers() const;
+    GSIZET num2DMeshLayers() const;
+    GSIZET num2DMeshNodes() const;
+    GSIZET num2DMeshFaces() const;
+    GBOOL do_subset() const;
+    vector<GUINT> lodStrides() const;
+    GSIZET numLODLevels() const { return lodStrides().size(); }
+    GSIZET numLayersPerWrite() const;
+    GUINT numWriterProcesses() const;
+    GBOOL do_write_profile() const;
+    GBOOL do_use_grid_cache() const;
+    GBOOL do_incremental() const;
+    GBOOL do_follow() const;
+    GDOUBLE followPollInterval() const;
+    GDOUBLE followTimeout() const;
+    const GHeaderInfo& header() const { return _header; }
     const vector<GString>& fieldVarNames() const { return _fieldVarNames; }
     const vector<GString>& allVarNames() const { return _allVarNames; }
-    const vector<GNode<T>>& nodes() const { return _nodes; }
-    const vector<GFace>& faces() const { return _faces; }
+    const GNodeStore<T>& nodes() const { return _nodes; }
+    const GSchema& schema() const { return _schema; }
+    const vector<GUINT>& faceNodes() const { return _faceNodes; }
+    GSIZET numFaces() const { return _faceNodes.size() / G_FACE_NODES; }
 
     /*!
      * Get the names of the grid and timestepped variables.
@@ -68,6 +99,29 @@ public:
      */
     bool fileExists(const GString& filename);
 
+    /*!
+     * Get the names of the x,y,z GeoFLOW grid files.
+     * 
+     * @return the grid filenames (relative to the input directory)
+     */
+    vector<GString> gridFilenames() const;
+
+    /*!
+     * Get the total size of a list of files in the input directory.
+     * 
+     * @param gfFilenames names of GeoFLOW files in the input directory
+     * @return total size in bytes (missing files count as 0)
+     */
+    GSIZET inputFileBytes(const vector<GString>& gfFilenames) const;
+
+    /*!
+     * Get the total size of a list of files in the output directory.
+     * 
+     * @param ncFilenames names of NetCDF files in the output directory
+     * @return total size in bytes (missing files count as 0)
+     */
+    GSIZET outputFileBytes(const vector<GString>& ncFilenames) const;
+
     /*!
      * Get the index corresponding to the variable name.
      *
@@ -112,9 +166,11 @@ public:
                                      const GString& zVarName);
 
     /*!
-     * Read GeoFLOW variable file and store data in nodes. Assumes the 
-     * correct number of nodes have already been initialized by the readGrid() 
-     * method.
+     * Read GeoFLOW variable file and store data in the variable's node 
+     * array. Assumes the correct number of nodes have already been 
+     * initialized by the readGrid() method. The file's values are read as 
+     * the type they are stored as (float or double, detected from the file 
+     * size) and converted to the node type.
      * 
      * @param gfFilename GeoFLOW variable filename
      * @param varName name of variable in nodes to store the data into
@@ -123,6 +179,116 @@ public:
     GHeaderInfo readGFVariableToNodes(const GString& gfFilename,
                                       const GString& varName);
 
+    /*!
+     * Compute the target position of each node (in GeoFLOW file order) in 
+     * the sorted volume directly from the grid header, without sorting. The 
+     * target order is the same as calling sortNodesByElemID() followed by 
+     * sortNodesBy2DMeshLayer(). Once computed, the grid and variable reads 
+     * scatter each value straight into its target position.
+     * 
+     * @param header header of a GeoFLOW grid file
+     */
+    void computeReorderPermutation(const GHeaderInfo& header);
+
+    /*!
+     * Read several GeoFLOW variable files concurrently and store each file's 
+     * data in its variable's node array. Each worker thread reads whole 
+     * files and writes only to the node arrays of the files it reads, so no 
+     * locking is needed. The number of workers is set by numReadThreads().
+     * 
+     * @param gfFilenames GeoFLOW variable filenames
+     * @param varNames name of variable in nodes to store each file's data 
+     *                 into
+     * @return the header info for each file read in
+     */
+    vector<GHeaderInfo> readGFVariablesToNodes(
+                                        const vector<GString>& gfFilenames,
+                                        const vector<GString>& varNames);
+
+    /*!
+     * Get the root names of the field variables (i.e., without a timestep).
+     *
+     * @return the root variable names
+     */
+    vector<GString> fieldRootVarNames() const;
+
+    /*!
+     * Add the field variables of a timestep that is not in the JSON file's 
+     * timesteps (i.e., one found while following the input directory) to 
+     * the variables that can be read and written. Variables that already 
+     * exist are not added again.
+     *
+     * @param timestep the timestep (e.g., 000012)
+     * @return the timestepped field variable names (i.e., rootName.timestep)
+     */
+    vector<GString> addTimestep(const GString& timestep);
+
+    /*!
+     * Check if a GeoFLOW variable file in the input directory has been 
+     * completely written: its size is the size of the grid header plus one 
+     * float or double value for every node in the volume.
+     *
+     * @param gfFilename name of the GeoFLOW variable file
+     * @return true if the file exists and is complete
+     */
+    GBOOL isVariableFileComplete(const GString& gfFilename) const;
+
+    /*!
+     * Free the node data of a variable once it has been written.
+     * 
+     * @param varName name of the variable in the nodes
+     */
+    void releaseNodeVariable(const GString& varName);
+
+    /*!
+     * Copy the grid read by MPI rank 0 to all other ranks: the grid header, 
+     * the reorder permutation, the element layer IDs and sort keys, and 
+     * every node variable rank 0 has allocated. Afterwards every rank holds 
+     * the same grid as if it had read the grid files itself.
+     * 
+     * @return the header info of the grid files
+     */
+    GHeaderInfo broadcastGrid();
+
+    /*!
+     * Load the grid from the grid cache file in the output directory if the 
+     * fingerprint of the grid files and grid settings matches the one it was 
+     * saved with and grid.nc is unchanged. A loaded grid has the header, 
+     * the reorder permutation, the duplicate layers, the subset's elements 
+     * and runs, and the faces, but no grid node values, so reading, 
+     * reordering and writing the grid is skipped.
+     * 
+     * @return true if the grid was loaded from the cache
+     */
+    GBOOL loadGridCache();
+
+    /*!
+     * Save the grid header, reorder permutation, duplicate layers, the 
+     * subset's elements and runs, and faces with the grid's fingerprint to 
+     * the grid cache file in the output directory. Call after grid.nc has 
+     * been written.
+     */
+    void saveGridCache();
+
+    /*!
+     * Get the fingerprint of the grid files and grid settings (computed 
+     * once). The grid settings include the variable definitions, so it also 
+     * identifies the settings the field variable files are written with.
+     *
+     * @return the fingerprint
+     */
+    GSIZET gridFingerprint();
+
+    /*!
+     * Get the timestepped field variable names this MPI rank converts. The 
+     * names are split across ranks by output file: by variable when each 
+     * variable is written to a separate file, otherwise by timestep. 
+     * Without MPI every name is returned.
+     * 
+     * @return the field variable names (i.e., root_name.timestep)
+     */
+    vector<GString> localFieldVarNames() const;
+
     /*!
      * Sort nodes by the nodes' GeoFLOW element IDs (bottom to top).
      */
@@ -135,18 +301,81 @@ public:
     void sortNodesBy2DMeshLayer();
 
     /*!
-     * Create a list of face to node mappings for one mesh layer (all mesh 
-     * layers have the same mapping).
+     * Select the part of the grid the subset settings ask for: the 2D mesh 
+     * layers in the selected element layers and depth (radius or z) range, 
+     * and the 2D elements with a node inside the horizontal ranges and 
+     * polygon. Only the selected elements of the selected layers are 
+     * written, with the faces numbered over the selected elements, and only 
+     * the runs of GeoFLOW elements that hold them are read from each field 
+     * variable file. Assumes the grid has been read with a reorder 
+     * permutation.
+     * 
+     * @param xVarName name of x (or longitude) variable in property tree
+     * @param yVarName name of y (or latitude) variable in property tree
+     * @param depthVarName name of radius (or z) variable in property tree
+     */
+    void selectSubset(const GString& xVarName, const GString& yVarName,
+                      const GString& depthVarName);
+
+    /*!
+     * Find the 2D mesh layers that are shared by adjacent GeoFLOW element 
+     * layers (the top layer of one element layer and the bottom layer of 
+     * the next). A bottom layer is a duplicate if every node's value of the 
+     * depth variable matches the top layer below it within the relative 
+     * tolerance duplicateLayerTolerance(). Duplicates are skipped when 
+     * writing node variables. With a subset, only its layers are written, 
+     * and a layer is a duplicate only if the layer below it is in the 
+     * subset too. Assumes the nodes are sorted by 2D mesh layer.
+     * 
+     * @param depthVarName name of radius (or z) variable in property tree
+     */
+    void findDuplicate2DMeshLayers(const GString& depthVarName);
+
+    /*!
+     * Create the face to node mapping for one mesh layer (all mesh layers 
+     * have the same mapping) as a flat buffer of G_FACE_NODES node indices 
+     * per face, ready to be written as mesh_face_nodes.
      */
     void faceToNodes();
 
+    /*!
+     * Set the level of detail that the mesh dimensions, faces and node 
+     * variables are written at. Level 0 is the output directory's level 
+     * (lod_stride), and each further level is a level of the pyramid 
+     * (lod_pyramid). At a stride k above 1, every k-th node (and the last 
+     * node) in each x,y reference direction of each 2D element is written, 
+     * and the faces join the written nodes. For a 3D grid, only the 2D mesh 
+     * layers at every k-th node (and the last node) in the z reference 
+     * direction of each element layer are written. Sets the mesh dimensions 
+     * in the schema for the level.
+     * 
+     * @param level index of the level in lodStrides()
+     */
+    void setLODLevel(GSIZET level);
+
+    /*!
+     * Get the directory of a level of detail's output files, relative to 
+     * the output directory.
+     * 
+     * @param level index of the level in lodStrides()
+     * @return the directory with a trailing slash ("" for level 0)
+     */
+    GString lodLevelDir(GSIZET level) const;
+
+    /*!
+     * Set the mesh dimensions (nMeshNodes, nMeshFaces and meshLayers) in 
+     * the schema to the number of nodes and faces per 2D mesh layer and 
+     * mesh layers written.
+     */
+    void setMeshDimensions();
+
     /*!
      * Get the timestep from the timestepped variable name.
      *
      * @param varName name of the variable
      * @return timestep (e.g., 000001)
      */
-    GString extractTimestep(GString varName);
+    GString extractTimestep(GString varName) const;
 
     /*!
      * Get the root variable name from the timestepped variable name.
@@ -154,17 +383,18 @@ public:
      * @param varName name of the timestepped variable (e.g., v1.000001)
      * @return root variable name (e.g., v1)
      */
-    GString extractRootVarName(GString varName);
+    GString extractRootVarName(GString varName) const;
 
     /*!
-     * Replace any 0-valued dimensions in the property tree with the matching 
+     * Replace any 0-valued dimensions in the schema with the matching 
      * dimensions specified in the input dimensions map. A 0-valued dimension 
      * means the dimension's value must be computed during runtime after 
      * reading a GeoFLOW data file. The name of a dimension in the map must 
      * match the name of a 0-valued dimension in the property tree.
      * 
      * @param dims map of key-value pairs of any dimensions that must be 
-     *             computed dynamically during runtime
+     *             computed dynamically during runtime (dimensions set by 
+     *             an earlier call are set again)
      */
     void setDimensions(const map<GString, GSIZET>& dims);
 
@@ -191,8 +421,8 @@ public:
     void closeNC();
 
     /*!
-     * Use dimensions in the property tree to write the dataset's dimensions 
-     * to the active NetCDF file.
+     * Use dimensions in the schema to write the dataset's dimensions to the 
+     * active NetCDF file.
      *
      */
     void writeNCDimensions();
@@ -240,18 +470,236 @@ public:
     void writeNCVariable(const GString& varName, const vector<U>& values);
 
 private:
+    /*!
+     * Store GeoFLOW data values (in GeoFLOW file order) into a variable's 
+     * node array. The values are scattered into their sorted positions if a 
+     * reorder permutation has been computed.
+     * 
+     * @param varIndex index of the variable to store the data into
+     * @param data data values read from a GeoFLOW file (a vector or a view 
+     *             of a mapped file)
+     * @param runsOnly true if data holds only the values of the subset's 
+     *                 element runs (packed in run order); otherwise data 
+     *                 holds the whole volume, of which only the subset's 
+     *                 runs are stored
+     */
+    template <typename S>
+    void storeVar(GUINT varIndex, const S& data, GBOOL runsOnly = false);
+
+    /*!
+     * Get a [min, max] range of the subset settings.
+     * 
+     * @param subset the subset settings in the property tree
+     * @param key name of the range
+     * @param minValue,maxValue the range to set
+     * @return false if the range is not in the settings
+     */
+    GBOOL getSubsetRange(const pt::ptree& subset, const GString& key,
+                         GDOUBLE& minValue, GDOUBLE& maxValue) const;
+
+    /*!
+     * Check if a point is inside a polygon (by ray casting).
+     * 
+     * @param polygon x,y of each polygon vertex (x0,y0,x1,y1,...)
+     * @param x,y the point
+     * @return true if the point is inside
+     */
+    static GBOOL insidePolygon(const vector<GDOUBLE>& polygon, 
+                               GDOUBLE x, GDOUBLE y);
+
+    /*!
+     * Get the node indices in one reference direction of an element written 
+     * at a level of detail: every stride-th index, and the last index.
+     * 
+     * @param polyOrder poly order of the reference direction
+     * @param stride the level of detail's stride
+     * @return the node indices
+     */
+    static vector<GUINT> lodIndices(GUINT polyOrder, GUINT stride);
+
+    /*!
+     * Get the num values read from each field variable file (the nodes of 
+     * the subset's element runs, or of the whole volume).
+     */
+    GSIZET numReadNodes() const;
+
+    /*!
+     * Find the element layers read from each field variable file, from the 
+     * subset's element runs, when the subset keeps every 2D element (so 
+     * whole element layers are read). Otherwise none are set.
+     */
+    void findReadLayerIDs();
+
+    /*!
+     * Read a GeoFLOW variable file whose values are of type U and store its 
+     * data (converted to the node type) in a variable's node array.
+     * 
+     * @param filename full path of the GeoFLOW variable file
+     * @param varIndex index of the variable to store the data into
+     * @return the header info for the file read in
+     */
+    template <typename U>
+    GHeaderInfo readGFVariableFile(const GString& filename, GUINT varIndex);
+
+    /*!
+     * Convert the x,y,z grid data values to lat,lon,radius and store them 
+     * in the nodes, along with each node's element layer ID.
+     * 
+     * @param header header of the x grid file
+     * @param x,y,z data values of the x,y,z grid files
+     * @param latVarName name of latitude variable in property tree
+     * @param lonVarName name of longitude variable in property tree
+     * @param radVarName name of radius variable in property tree
+     */
+    template <typename S>
+    void storeLatLonRadNodes(const GHeaderInfo& header,
+                             const S& x, const S& y, const S& z,
+                             const GString& latVarName,
+                             const GString& lonVarName,
+                             const GString& radVarName);
+
+    /*!
+     * Store the x,y,z grid data values in the nodes, along with each node's 
+     * element layer ID.
+     * 
+     * @param header header of the x grid file
+     * @param x,y,z data values of the x,y,z grid files
+     * @param xVarName name of x variable in property tree
+     * @param yVarName name of y variable in property tree
+     * @param zVarName name of z/elevation variable in property tree
+     */
+    template <typename S>
+    void storeBoxNodes(const GHeaderInfo& header,
+                       const S& x, const S& y, const S& z,
+                       const GString& xVarName,
+                       const GString& yVarName,
+                       const GString& zVarName);
+
+    /*!
+     * Read the x,y,z grid files concurrently, one thread per file.
+     * 
+     * @param xFilename,yFilename,zFilename names of the x,y,z grid files
+     * @param x,y,z readers created for the x,y,z grid files
+     */
+    template <class R>
+    static void readGridFiles(const GString& xFilename,
+                              const GString& yFilename,
+                              const GString& zFilename,
+                              unique_ptr<R>& x,
+                              unique_ptr<R>& y,
+                              unique_ptr<R>& z);
+
+    /*!
+     * Get a pointer to a block of contiguous data values. Values in a 
+     * vector are used in place; values viewed in a mapped file are copied 
+     * into the input buffer first since they may not be aligned.
+     * 
+     * @param data data values
+     * @param offset position of the first value in the block
+     * @param n number of values in the block
+     * @param buf buffer of at least n values
+     * @return pointer to the block of values
+     */
+    static const T* blockValues(const vector<T>& data, GSIZET offset, 
+                                GSIZET n, T* buf)
+    {
+        return data.data() + offset;
+    }
+    static const T* blockValues(const GSpan<T>& data, GSIZET offset, 
+                                GSIZET n, T* buf)
+    {
+        data.copyTo(offset, n, buf);
+        return buf;
+    }
+
+    /*!
+     * Set each node's element layer ID from the header's element ID array.
+     * 
+     * @param header header of a GeoFLOW grid file
+     */
+    void storeElemLayerIDs(const GHeaderInfo& header);
+
+    /*!
+     * Check if two 2D mesh layers of a node variable hold the same values 
+     * (within the duplicate layer tolerance).
+     * 
+     * @param v node variable values sorted by 2D mesh layer
+     * @param a,b indices of the two 2D mesh layers to compare
+     * @return true if the layers match
+     */
+    GBOOL layersMatch(const vector<T>& v, GSIZET a, GSIZET b) const;
+
+    /*!
+     * Relative tolerance used when comparing duplicate 2D mesh layers.
+     */
+    GDOUBLE duplicateLayerTolerance() const;
+
+    /*!
+     * Exit if the x,y,z grid files have different numbers of values.
+     */
+    void verifyGridSize(GSIZET xSize, GSIZET ySize, GSIZET zSize);
+
+    /*!
+     * Exit if a variable file's number of values differs from the number 
+     * of nodes.
+     */
+    void verifyVarSize(const GString& filename, GSIZET size);
+
+    /*!
+     * Get the grid settings that change grid.nc, as a string that goes into 
+     * the grid fingerprint.
+     */
+    GString gridSettings() const;
+
+    /*!
+     * Get the total size of a list of files in a directory.
+     */
+    GSIZET fileBytes(const GString& dirName, 
+                     const vector<GString>& filenames) const;
+
     GString _ptFilename;     // filename that contains the property tree
     pt::ptree _ptRoot;       // root of property tree
+    GSchema _schema;         // NetCDF dimensions and variables compiled from 
+                             // the property tree
     GToNetCDF *_nc;          // handle to NetCDF writer 
     GHeaderInfo _header;     // header of a GeoFLOW grid file
-    vector<GNode<T>> _nodes; // location and variable data for every node in 
-                             // the GeoFLOW dataset
-    vector<GFace> _faces;    // the faces that make up one 2D layer (x,y ref 
-                             // dir) of the GeoFLOW dataset
+    GNodeStore<T> _nodes;    // location and variable data for every node in 
+                             // the GeoFLOW dataset (one array per variable)
+    vector<GUINT> _faceNodes; // node indices of the faces that make up one 
+                              // 2D layer (x,y ref dir) of the GeoFLOW 
+                              // dataset, G_FACE_NODES per face
+    vector<GSIZET> _reorder; // target position in the sorted volume of each 
+                             // node in GeoFLOW file order (empty if the 
+                             // nodes get sorted instead)
+    vector<GSIZET> _outLayers; // sorted 2D mesh layers to write (empty if 
+                               // all layers are written)
+    vector<GSIZET> _dupLayers; // sorted 2D mesh layers skipped as duplicates 
+                               // of the layer below them
+    vector<GSIZET> _subsetLayers; // sorted 2D mesh layers selected by the 
+                                  // subset (empty if no subset)
+    vector<GSIZET> _outElems; // 2D elements (by position in a sorted 2D 
+                              // mesh layer) written (empty if all)
+    vector<GElemRun> _readRuns; // runs of GeoFLOW elements read from each 
+                                // field variable file (empty if all)
+    set<GSIZET> _readLayerIDs;  // GeoFLOW element layers read from each 
+                                // field variable file (empty unless whole 
+                                // element layers are read)
+    vector<GUINT> _lodNodes; // nodes of a 2D element written at the current 
+                             // level of detail (empty if all)
+    GUINT _lodNX, _lodNY;    // num nodes written in the x,y ref dir of a 2D 
+                             // element (with _lodNodes)
+    vector<GSIZET> _lodLayers; // sorted 2D mesh layers written at the 
+                               // current level of detail (empty if those 
+                               // of _outLayers)
+    set<GUINT> _runtimeDims; // schema dimensions set at runtime
+    GSIZET _gridFingerprint; // fingerprint of the grid files and settings 
+                             // (0 until computed)
     GString _inputDir;       // directory name of input GeoFLOW files
     GString _outputDir;      // directory name of output NetCDF files
     GUINT _numTimesteps;     // number of timesteps to convert
     vector<GString> _allVarNames; // all var names (grid & timestepped field)
+    unordered_map<GString, GUINT> _varIndices; // index of each var name in 
+                                               // _allVarNames
     vector<GString> _fieldVarNames; // timestepped field variables names
                                     // (i.e., root_name.timestep)    
 };
@@ -0,0 +1,124 @@
+//==============================================================================
+// Date        : 10/16/26 (agent)
+// Description : Checks the GeoFLOW files of a dataset before it is converted,
+//               from their headers and sizes only. Every grid and field
+//               variable file named by the JSON file is checked for being
+//               present, having a readable header, having the byte size of
+//               one float or double value per node, and having the same
+//               elements (dim, poly orders, element count and element
+//               layers) as the x grid file. The problems found are reported
+//               as JSON.
+// Copyright   : Copyright 2021. Regents of the University of Colorado.
+//               All rights reserved.
+//==============================================================================
+
+#ifndef GDATASETVALIDATOR_H
+#define GDATASETVALIDATOR_H
+
+#include <vector>
+#include <iostream>
+
+#include "gtypes.h"
+#include "gheader_info.h"
+#include "pt_util.h"
+
+using namespace std;
+
+// A problem found in a GeoFLOW file
+struct GValidationProblem
+{
+    GString file;     // filename (relative to the input directory)
+    GString severity; // "error" or "warning"
+    GString check;    // name of the check that failed
+    GString message;  // description of the problem
+};
+
+// What was found in a GeoFLOW file
+struct GValidationFile
+{
+    GString name;                        // filename (in the input directory)
+    GString timestep;                    // timestep ("" for grid files)
+    GBOOL hasHeader;                     // true if the header was read
+    GSIZET size;                         // byte size of the file
+    GSIZET valueBytes;                   // byte size of each value (0 if
+                                         // the size does not match)
+    GHeaderInfo header;                  // header (without the element IDs)
+    vector<GValidationProblem> problems; // problems found in the file
+};
+
+class GDatasetValidator
+{
+public:
+    /*!
+     * Find the grid and field variable files of a dataset.
+     *
+     * @param ptFilename name of the JSON file of the dataset
+     */
+    GDatasetValidator(const GString& ptFilename);
+    ~GDatasetValidator() {}
+
+    /*!
+     * Check every file of the dataset. The x grid file is checked first, as
+     * the reference for the others, which are then checked concurrently.
+     *
+     * @return the number of errors found
+     */
+    GSIZET validate();
+
+    /*!
+     * Write the report of the checks as JSON.
+     *
+     * @param os stream to write to
+     * @param withFiles true to also list the header info of every file
+     */
+    void writeReport(ostream& os, GBOOL withFiles) const;
+
+private:
+    /*!
+     * Add the files of the field variables at each timestep.
+     *
+     * @param rootVarNames root names of the field variables
+     * @param timesteps timesteps (none if the files have no timestep)
+     */
+    void addFieldFiles(const vector<GString>& rootVarNames,
+                       const vector<GString>& timesteps);
+
+    /*!
+     * Read the header and size of a file and check them against the x grid
+     * file's header.
+     *
+     * @param f the file to check
+     * @param ref header of the x grid file (0 to check the x grid file)
+     */
+    void checkFile(GValidationFile& f, const GHeaderInfo* ref) const;
+
+    /*!
+     * Check that the element layers of the x grid file have the same number
+     * of elements, as the conversion assumes.
+     *
+     * @param f the x grid file
+     */
+    static void checkElementLayers(GValidationFile& f);
+
+    /*!
+     * Check that the field files of each timestep have the same time.
+     */
+    void checkTimes();
+
+    /*!
+     * Add a problem to a file.
+     *
+     * @param f the file
+     * @param severity "error" or "warning"
+     * @param check name of the check that failed
+     * @param message description of the problem
+     */
+    static void addProblem(GValidationFile& f, const GString& severity,
+                           const GString& check, const GString& message);
+
+    GString _ptFilename;            // JSON file of the dataset
+    GString _inputDir;              // directory of the GeoFLOW files
+    vector<GValidationFile> _files; // files of the dataset (x grid first)
+};
+
+#endif
@@ -0,0 +1,56 @@
+//==============================================================================
+// Date        : 10/16/26 (agent)
+// Description : Waits for files to be written to a directory. Changes are
+//               reported by inotify where it is available, with a polling
+//               interval as the upper bound on each wait, so files written
+//               where inotify sees no events (i.e., by another node of a
+//               network file system) are still found.
+// Copyright   : Copyright 2021. Regents of the University of Colorado.
+//               All rights reserved.
+//==============================================================================
+
+#ifndef GDIRWATCHER_H
+#define GDIRWATCHER_H
+
+#include <vector>
+
+#include "gtypes.h"
+
+using namespace std;
+
+class GDirWatcher
+{
+public:
+    /*!
+     * Start watching a directory.
+     *
+     * @param dirName name of the directory to watch
+     * @param pollSeconds max time to wait for a change before returning
+     */
+    GDirWatcher(const GString& dirName, GDOUBLE pollSeconds);
+
+    ~GDirWatcher();
+
+    GBOOL usesInotify() const { return _fd >= 0; }
+
+    /*!
+     * Wait until a file in the directory is created, written and closed, or
+     * moved in, the polling interval passes, or a signal is caught.
+     */
+    void wait();
+
+    /*!
+     * Get the names of the files in a directory.
+     *
+     * @param dirName name of the directory
+     * @return the filenames (without the directory name)
+     */
+    static vector<GString> listFiles(const GString& dirName);
+
+private:
+    GString _dirName;     // directory being watched
+    GDOUBLE _pollSeconds; // max time of a wait
+    int _fd;              // inotify file descriptor (-1 when polling)
+};
+
+#endif
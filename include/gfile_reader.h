@@ -8,15 +8,47 @@
 #ifndef GFILEREADER_H
 #define GFILEREADER_H
 
+#include <set>
+#include <sys/uio.h>
+
 #include "gheader_info.h"
 
 using namespace std;
 
+// Runs of elements separated by at most this many bytes are read with a 
+// single positioned read (the bytes between them are read and dropped)
+#define G_MAX_READ_GAP_BYTES 65536
+
+// Max num buffers (runs and gaps) of a single vectored read of element runs
+#define G_MAX_READ_IOVECS 1024
+
 template <class T>
 class GFileReader
 {
 public:
     GFileReader(const GString& filename);
+
+    /*!
+     * Constructor: Reads the header and only the data values of the given 
+     * runs of elements from a GeoFLOW file. The values of the runs are 
+     * packed one after the other (in the order of the runs), and the 
+     * element layer IDs are not set.
+     * 
+     * @param filename input GeoFLOW filename
+     * @param runs runs of elements to read
+     */
+    GFileReader(const GString& filename, const vector<GElemRun>& runs);
+
+    /*!
+     * Constructor: Reads the header and only the data values of the 
+     * elements in the given element layers from a GeoFLOW file (see 
+     * elementLayerRuns()). The values are packed in file order, and the 
+     * element layer ID of each value is set.
+     * 
+     * @param filename input GeoFLOW filename
+     * @param layerIDs GeoFLOW element layer IDs of the elements to read
+     */
+    GFileReader(const GString& filename, const set<GSIZET>& layerIDs);
     ~GFileReader() {}
 
     /*!
@@ -28,6 +60,38 @@ public:
      */
     static GHeaderInfo readHeader(const GString& filename);
 
+    /*!
+     * Read the header from the GeoFLOW file, reporting a file that cannot be 
+     * read instead of exiting.
+     * 
+     * @param filename input GeoFLOW file name
+     * @param h the header to populate
+     * @param msg the reason the header cannot be read, if any
+     * @return false if the header cannot be read
+     */
+    static GBOOL readHeader(const GString& filename, GHeaderInfo& h,
+                            GString& msg);
+
+    /*!
+     * Get the byte size of the data values of a GeoFLOW file from its header 
+     * and file size (see GHeaderInfo::valueBytes()).
+     * 
+     * @param filename input GeoFLOW file name
+     * @return sizeof(GFLOAT) or sizeof(GDOUBLE), or 0 if unknown
+     */
+    static GSIZET readValueBytes(const GString& filename);
+
+    /*!
+     * Get the runs of consecutive elements of a GeoFLOW file that belong to 
+     * a set of element layers, from the element IDs in its header.
+     * 
+     * @param header header of the GeoFLOW file
+     * @param layerIDs GeoFLOW element layer IDs
+     * @return the runs, in file order
+     */
+    static vector<GElemRun> elementLayerRuns(const GHeaderInfo& header,
+                                             const set<GSIZET>& layerIDs);
+
     /*!
      * Read the data values from the GeoFLOW file.
      *
@@ -35,6 +99,17 @@ public:
      */
     void readData(const GString& filename);
 
+    /*!
+     * Read the data values of runs of elements from the GeoFLOW file, with 
+     * one positioned read per run, or per group of runs in file order that 
+     * are separated by at most G_MAX_READ_GAP_BYTES.
+     *
+     * @param filename input GeoFLOW filename
+     * @param runs runs of elements to read
+     */
+    void readElementRuns(const GString& filename, 
+                         const vector<GElemRun>& runs);
+
     // Access
     const GHeaderInfo header() const { return _header; }
     const vector<T>& data() const { return _data; }
@@ -46,12 +121,42 @@ public:
      */
     void setElementLayerIDs();
 
+    /*!
+     * Set an element layer ID for each data value read from runs of 
+     * elements.
+     * 
+     * @param runs runs of elements the data values were read from
+     */
+    void setElementLayerIDs(const vector<GElemRun>& runs);
+
     /*!
      * Print each data value on a new line.
      */
     void printData();
 
 private:
+    /*!
+     * Exit if the data values of the GeoFLOW file are not sizeof(T) bytes 
+     * each.
+     *
+     * @param filename input GeoFLOW filename
+     * @param fileSize byte size of the file
+     */
+    void verifyValueBytes(const GString& filename, GSIZET fileSize);
+
+    /*!
+     * Read a range of bytes from a file into a list of buffers, filled in 
+     * order (retrying short reads), and exit if they cannot be read.
+     *
+     * @param fd file descriptor of the file
+     * @param iov buffers of nBytes bytes in total (moved past what is read)
+     * @param nBytes num bytes to read
+     * @param offset byte position of the range in the file
+     * @param filename name of the file (for the error message)
+     */
+    static void readBytes(int fd, vector<struct iovec>& iov, GSIZET nBytes, 
+                          GSIZET offset, const GString& filename);
+
     GHeaderInfo _header;          // GeoFLOW file header & other meta data
     vector<T> _data;              // GeoFLOW file data values
     vector<GSIZET> _elemLayerIDs; // element layer ID for each data value
@@ -0,0 +1,97 @@
+//==============================================================================
+// Date        : 10/16/26 (agent)
+// Description : Cache of the grid work of a conversion (the node reorder
+//               permutation, duplicate layers, subset and face connectivity,
+//               and the size and modification time of the grid.nc written
+//               with them), saved with a fingerprint of the grid files'
+//               headers and contents and of the settings that shape grid.nc.
+//               A later run whose fingerprint matches loads the cache instead
+//               of reading and reordering the grid.
+// Copyright   : Copyright 2021. Regents of the University of Colorado.
+//               All rights reserved.
+//==============================================================================
+
+#ifndef GGRIDCACHE_H
+#define GGRIDCACHE_H
+
+#include <vector>
+
+#include "gtypes.h"
+#include "gheader_info.h"
+
+using namespace std;
+
+// The grid data saved in a cache file
+struct GGridCacheData
+{
+    GSIZET fingerprint;        // fingerprint of the grid files and settings
+    GUINT valueBytes;          // byte size of a node value (sizeof(T))
+    GHeaderInfo header;        // header of the x grid file
+    GSIZET numNodes;           // num nodes in the volume
+    vector<GSIZET> reorder;    // node reorder permutation
+    vector<GSIZET> outLayers;  // 2D mesh layers written (empty = all)
+    vector<GSIZET> dupLayers;  // 2D mesh layers skipped as duplicates
+    vector<GSIZET> outElems;   // 2D elements written (empty = all)
+    vector<GElemRun> readRuns; // element runs read from field variable 
+                               // files (empty = all)
+    vector<GUINT> faceNodes;   // face connectivity of one 2D mesh layer
+    GSIZET gridFileBytes;      // size of the grid.nc written from the data
+    GLLONG gridFileMtime;      // modification time of that grid.nc in ns
+};
+
+class GGridCache
+{
+public:
+    GGridCache() {}
+    ~GGridCache() {}
+
+    /*!
+     * Compute the fingerprint of a grid: a 64-bit hash of each grid file's
+     * size, header and data (the files are hashed concurrently) and of a
+     * string holding the settings that shape grid.nc.
+     *
+     * @param filenames full paths of the x,y,z grid files
+     * @param settings settings that change the grid output
+     * @return the fingerprint
+     */
+    static GSIZET fingerprint(const vector<GString>& filenames,
+                              const GString& settings);
+
+    /*!
+     * Read a cache file.
+     *
+     * @param filename name of the cache file
+     * @param data the cache data to populate
+     * @return true if the file exists and is a complete cache file
+     */
+    static GBOOL read(const GString& filename, GGridCacheData& data);
+
+    /*!
+     * Write a cache file. The file is written under a temporary name and
+     * renamed, so an interrupted write never leaves a partial cache file.
+     *
+     * @param filename name of the cache file
+     * @param data the cache data to write
+     */
+    static void write(const GString& filename, const GGridCacheData& data);
+
+private:
+    /*!
+     * Add bytes to a running 64-bit hash, 8 bytes at a time.
+     *
+     * @param h the hash to update
+     * @param data address of the bytes
+     * @param n number of bytes
+     */
+    static void hashBytes(GSIZET& h, const char* data, GSIZET n);
+
+    /*!
+     * Hash the size and contents of a file.
+     *
+     * @param filename name of the file
+     * @return hash of the file
+     */
+    static GSIZET hashFile(const GString& filename);
+};
+
+#endif
@@ -10,11 +10,21 @@
 #define GHEADERINFO_H
 
 #include <vector>
+#include <set>
+#include <sstream>
 
 #include "gtypes.h"
+#include "logger.h"
 
 using namespace std;
 
+// A run of consecutive elements of a GeoFLOW file (in file order)
+struct GElemRun
+{
+    GSIZET first; // index of the first element in the run
+    GSIZET count; // num elements in the run
+};
+
 struct GHeaderInfo
 {
     // Data stored in GeoFLOW file header
@@ -40,46 +50,120 @@ struct GHeaderInfo
     GSIZET        nElemLayers;       // num GF element layers
     GSIZET        nElemPerElemLayer; // num GF elements per GF element layer
 
+    /*!
+     * Compute the auxiliary data from the data stored in the GeoFLOW file 
+     * header. Assumes nHeaderBytes and the header data have been set.
+     */
+    void deriveInfo()
+    {
+        // Get num nodes per GeoFLOW element (2D or 3D). Num nodes in one 
+        // reference direction of one element = (poly order + 1)
+        nNodesPerElem = 1;
+        for (const auto& p : polyOrder)
+        {
+            nNodesPerElem *= (p+1);
+        }
+
+        // Get num nodes in volume
+        nNodesPerVolume = nElems * nNodesPerElem;
+
+        // Get num nodes per 2D element (x,y ref dir). Num nodes in one 
+        // reference direction of one element = (poly order + 1)
+        nNodesPer2DElem = 1;
+        for (auto i = 0u; i < 2; ++i)
+        {
+            nNodesPer2DElem *= (polyOrder[i] + 1);
+        }
+
+        // Get num GeoFLOW element layers (the low word of an element ID is 
+        // its element layer)
+        set<GSIZET> uniqueIDs;
+        for (auto id : elemIDs)
+        {
+            uniqueIDs.insert(GET_LOWORD(id));
+        }
+        nElemLayers = uniqueIDs.size();
+
+        // Get num GeoFLOW elments per GeoFLOW element layer
+        nElemPerElemLayer = nElems / nElemLayers;
+
+        // Get num nodes per 2D layer (x,y ref dir)
+        nNodesPer2DLayer = nElemPerElemLayer * nNodesPer2DElem;
+
+        // Get num faces (includes sub faces) per 2D layer (x,y ref dir)
+        nFacesPer2DLayer = nElemPerElemLayer * (polyOrder[0] * polyOrder[1]);
+
+        // Get num 2D layers in the entire volume
+        n2DLayers = nNodesPerVolume / nNodesPer2DLayer;
+    }
+
+    /*!
+     * Get the byte size of each data value of a GeoFLOW file from the size 
+     * of the file, when its data is one value per node in the volume. 
+     * Assumes the derived header info has been computed.
+     * 
+     * @param fileSize byte size of the GeoFLOW file
+     * @return sizeof(GFLOAT) or sizeof(GDOUBLE), or 0 if the data size is 
+     *         neither (i.e., a file with multiple fields)
+     */
+    GSIZET valueBytes(GSIZET fileSize) const
+    {
+        GSIZET nDataBytes = fileSize > nHeaderBytes ? 
+                            fileSize - nHeaderBytes : 0;
+        if (nDataBytes == nNodesPerVolume * sizeof(GFLOAT))
+        {
+            return sizeof(GFLOAT);
+        }
+        if (nDataBytes == nNodesPerVolume * sizeof(GDOUBLE))
+        {
+            return sizeof(GDOUBLE);
+        }
+        return 0;
+    }
+
     /*!
      * Print the header info extracted from the GeoFLOW file, along with the 
-     * derived header info.
+     * derived header info. Only printed at the debug log level.
      */
     void printHeader()
     {
-       cout << endl;
-       cout << "-----------" << endl;
-       cout << "Header Info" << endl;
-       cout << "-----------" << endl;
-       cout << "IO version: " << version << endl;
-       cout << "Dimension: " << dim << endl;
-       cout << "Num elements: " << nElems << endl;
-       cout << "Poly orders: "; 
+       if (!Logger::enabled(GL_DEBUG)) { return; }
+
+       ostringstream out;
+       out << endl;
+       out << "-----------" << endl;
+       out << "Header Info" << endl;
+       out << "-----------" << endl;
+       out << "IO version: " << version << endl;
+       out << "Dimension: " << dim << endl;
+       out << "Num elements: " << nElems << endl;
+       out << "Poly orders: "; 
        for (const auto& p : polyOrder)
        {
-           cout << p << " ";
+           out << p << " ";
        }
-       cout << endl;
-       cout << "Grid type: " << gridType << endl;
-       cout << "Time cycle: " << timeCycle << endl;
-       cout << "Time stamp: " << timeStamp << endl;
-       cout << "Has mult fields?: " << hasMultVars << endl;
+       out << endl;
+       out << "Grid type: " << gridType << endl;
+       out << "Time cycle: " << timeCycle << endl;
+       out << "Time stamp: " << timeStamp << endl;
+       out << "Has mult fields?: " << hasMultVars << endl;
 
        // Print derived header info
-       cout << endl;
-       cout << "------------------------" << endl;
-       cout << "Derived Info from Header" << endl;
-       cout << "------------------------" << endl;
-       cout << "Num header bytes: " << nHeaderBytes << endl;
-       cout << "Num nodes per element: " << nNodesPerElem << endl;
-       cout << "Num nodes per volume: " << nNodesPerVolume << endl;
-       cout << "Num nodes per 2D element (x,y ref dir only): " 
-            << nNodesPer2DElem << endl;
-       cout << "Num element layers: " << nElemLayers << endl;
-       cout << "Num elements per layer: " << nElemPerElemLayer << endl;
-       cout << "Num 2D mesh layers: " << n2DLayers << endl;
-       cout << "Num nodes per 2D mesh layer: " << nNodesPer2DLayer << endl;
-       cout << "Num faces per 2D mesh layer: " << nFacesPer2DLayer << endl;
-       cout << endl;
+       out << endl;
+       out << "------------------------" << endl;
+       out << "Derived Info from Header" << endl;
+       out << "------------------------" << endl;
+       out << "Num header bytes: " << nHeaderBytes << endl;
+       out << "Num nodes per element: " << nNodesPerElem << endl;
+       out << "Num nodes per volume: " << nNodesPerVolume << endl;
+       out << "Num nodes per 2D element (x,y ref dir only): " 
+           << nNodesPer2DElem << endl;
+       out << "Num element layers: " << nElemLayers << endl;
+       out << "Num elements per layer: " << nElemPerElemLayer << endl;
+       out << "Num 2D mesh layers: " << n2DLayers << endl;
+       out << "Num nodes per 2D mesh layer: " << nNodesPer2DLayer << endl;
+       out << "Num faces per 2D mesh layer: " << nFacesPer2DLayer << endl;
+       Logger::print(GL_DEBUG, out.str());
    }
 };
 
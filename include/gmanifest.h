@@ -0,0 +1,134 @@
+//==============================================================================
+// Date        : 10/16/26 (agent)
+// Description : Manifest of the NetCDF files a conversion has completed. Each
+//               entry records an output file's size and the size and
+//               modification time of each GeoFLOW file it was converted from,
+//               with the fingerprint of the grid and the settings in effect.
+//               An incremental conversion skips any output whose entry is
+//               still current. Entries are appended to the manifest file as
+//               each output completes (from any writer process or MPI rank),
+//               and the file is compacted at the end of the run.
+// Copyright   : Copyright 2021. Regents of the University of Colorado.
+//               All rights reserved.
+//==============================================================================
+
+#ifndef GMANIFEST_H
+#define GMANIFEST_H
+
+#include <map>
+#include <vector>
+
+#include "gtypes.h"
+
+using namespace std;
+
+// Size and modification time of a file
+struct GManifestFile
+{
+    GString name;      // filename (relative to its input or output directory)
+    GSIZET size;       // size in bytes
+    GLLONG mtime;      // modification time in nanoseconds since the epoch
+};
+
+// A completed output file and the input files it was converted from
+struct GManifestEntry
+{
+    GSIZET fingerprint;            // fingerprint of the grid and settings
+    GManifestFile output;          // the NetCDF file (mtime is not used)
+    vector<GManifestFile> sources; // the GeoFLOW files it was converted from
+};
+
+class GManifest
+{
+public:
+    GManifest() : _fingerprint(0) {}
+    ~GManifest() {}
+
+    /*!
+     * Read the manifest file of an output directory. Entries recorded with a
+     * different fingerprint are ignored. Until open() is called, no output
+     * is current and record() does nothing.
+     *
+     * @param inputDir directory of the GeoFLOW files
+     * @param outputDir directory of the NetCDF files and the manifest file
+     * @param fingerprint fingerprint of the grid and settings of this run
+     */
+    void open(const GString& inputDir, const GString& outputDir,
+              GSIZET fingerprint);
+
+    GBOOL isOpen() const { return !_filename.empty(); }
+
+    /*!
+     * Check if an output file is current: it has an entry, it still has the
+     * size it was written with, and its input files are the same ones, with
+     * the same sizes and modification times, as when it was converted.
+     *
+     * @param output name of the NetCDF file in the output directory
+     * @param sources names of its GeoFLOW files in the input directory
+     * @return true if the output does not need to be converted again
+     */
+    GBOOL isCurrent(const GString& output,
+                    const vector<GString>& sources) const;
+
+    /*!
+     * Take a snapshot of the input files of an output about to be converted.
+     * Call before the input files are read, so an input file that changes
+     * during the conversion leaves the output stale.
+     *
+     * @param output name of the NetCDF file in the output directory
+     * @param sources names of its GeoFLOW files in the input directory
+     */
+    void stage(const GString& output, const vector<GString>& sources);
+
+    /*!
+     * Append the entry of a staged output to the manifest file once the
+     * output has been written. The entry is appended with a single write to
+     * a file opened for appending, so writer processes and MPI ranks can
+     * record outputs at the same time.
+     *
+     * @param output name of the NetCDF file in the output directory
+     */
+    void record(const GString& output) const;
+
+    /*!
+     * Rewrite the manifest file with only the latest current-fingerprint
+     * entry of each output. Call from one process once all outputs are
+     * recorded. The file is written under a temporary name and renamed.
+     */
+    void compact() const;
+
+    /*!
+     * Get the size and modification time of a file.
+     *
+     * @param filename full path of the file
+     * @param file the size and time to populate
+     * @return false if the file does not exist
+     */
+    static GBOOL statFile(const GString& filename, GManifestFile& file);
+
+private:
+    /*!
+     * Read the entries of the manifest file recorded with this run's
+     * fingerprint; a later entry of an output replaces an earlier one.
+     *
+     * @param entries the entries to populate, by output name
+     */
+    void readEntries(map<GString, GManifestEntry>& entries) const;
+
+    /*!
+     * Format an entry as one tab-separated manifest line.
+     *
+     * @param e the entry
+     * @return the line, with a trailing newline
+     */
+    static GString formatEntry(const GManifestEntry& e);
+
+    GString _inputDir;                       // directory of the GeoFLOW files
+    GString _outputDir;                      // directory of the NetCDF files
+    GString _filename;                       // full path of the manifest file
+    GSIZET _fingerprint;                     // fingerprint of this run
+    map<GString, GManifestEntry> _entries;   // current entries, by output
+    map<GString, GManifestEntry> _staged;    // outputs being converted
+};
+
+#endif
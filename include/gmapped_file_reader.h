@@ -0,0 +1,65 @@
+//==============================================================================
+// Date         : 10/16/26 (agent)
+// Description  : Reads header and data from a binary GeoFLOW data file that 
+//                is memory-mapped. The header is parsed in place and the 
+//                data values are exposed as a read-only view of the mapping.
+// Copyright    : Copyright 2021. Regents of the University of Colorado.
+//                All rights reserved.
+//==============================================================================
+
+#ifndef GMAPPEDFILEREADER_H
+#define GMAPPEDFILEREADER_H
+
+#include "gheader_info.h"
+#include "gspan.h"
+
+using namespace std;
+
+template <class T>
+class GMappedFileReader
+{
+public:
+    /*!
+     * Constructor: Maps a GeoFLOW file into memory and parses its header.
+     *
+     * @param filename input GeoFLOW filename
+     */
+    GMappedFileReader(const GString& filename);
+    ~GMappedFileReader();
+
+    // Access
+    const GHeaderInfo& header() const { return _header; }
+    GSpan<T> data() const { return _data; }
+    GSIZET fileSize() const { return _fileSize; }
+
+private:
+    // A mapping is owned by one reader only
+    GMappedFileReader(const GMappedFileReader&);
+    GMappedFileReader& operator=(const GMappedFileReader&);
+
+    /*!
+     * Parse the header at the start of the mapped file.
+     */
+    void parseHeader();
+
+    /*!
+     * Copy a header value out of the mapped file and advance the read 
+     * position.
+     *
+     * @param pos byte position of the value in the file
+     * @param value header value to set
+     */
+    template <typename U>
+    void readValue(GSIZET& pos, U& value);
+
+    GString _filename;    // name of the mapped file
+    int _fd;              // file descriptor of the mapped file
+    char* _map;           // start of the mapped file
+    GSIZET _fileSize;     // byte size of the mapped file
+    GHeaderInfo _header;  // GeoFLOW file header & other meta data
+    GSpan<T> _data;       // GeoFLOW file data values (inside the mapping)
+};
+
+#include "../src/gmapped_file_reader.ipp"
+
+#endif
@@ -0,0 +1,228 @@
+//==============================================================================
+// Date        : 10/16/26 (agent)
+// Description : Stores the location and variable data of every GeoFLOW node
+//               in a columnar layout (one contiguous array per variable).
+// Copyright   : Copyright 2021. Regents of the University of Colorado.
+//               All rights reserved.
+//==============================================================================
+
+#ifndef GNODESTORE_H
+#define GNODESTORE_H
+
+#include <iostream>
+#include <vector>
+
+#include "gtypes.h"
+#include "logger.h"
+
+using namespace std;
+
+template <class T>
+class GNodeStore
+{
+public:
+    GNodeStore() : _numNodes(0) {}
+    ~GNodeStore() {}
+
+    /*!
+     * Initialize the store for a given number of variables and nodes. The
+     * element layer ID and sort key arrays are allocated here; a variable's
+     * array is only allocated when allocVar() is called for it.
+     *
+     * @param numVars total number of variables (grid and field) to store
+     * @param numNodes number of nodes in the GeoFLOW volume
+     */
+    void init(GUINT numVars, GSIZET numNodes)
+    {
+        clear();
+        _numNodes = numNodes;
+        _vars.resize(numVars);
+
+        try
+        {
+            _elemLayerIDs.resize(numNodes);
+            _sortKeys.resize(numNodes);
+        }
+        catch (const std::bad_alloc& e)
+        {
+            std::string msg = "Error setting capacity (" + \
+                              to_string(numNodes) + ") for node element " \
+                              "layer IDs and sort keys.";
+            Logger::error(__FILE__, __FUNCTION__, msg);
+            cerr << e.what() << endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    /*!
+     * Release all variable arrays, element layer IDs and sort keys.
+     */
+    void clear()
+    {
+        _vars.clear();
+        _vars.shrink_to_fit();
+        _elemLayerIDs.clear();
+        _elemLayerIDs.shrink_to_fit();
+        _sortKeys.clear();
+        _sortKeys.shrink_to_fit();
+        _numNodes = 0;
+    }
+
+    // Access
+    GSIZET size() const { return _numNodes; }
+    GUINT numVars() const { return _vars.size(); }
+    vector<GSIZET>& elemLayerIDs() { return _elemLayerIDs; }
+    const vector<GSIZET>& elemLayerIDs() const { return _elemLayerIDs; }
+    vector<GUINT>& sortKeys() { return _sortKeys; }
+    const vector<GUINT>& sortKeys() const { return _sortKeys; }
+
+    /*!
+     * Allocate the array of a variable (one value per node).
+     *
+     * @param varIndex index of the variable
+     * @return the variable's array
+     */
+    vector<T>& allocVar(GUINT varIndex)
+    {
+        vector<T>& v = var(varIndex);
+        try
+        {
+            v.resize(_numNodes);
+        }
+        catch (const std::bad_alloc& e)
+        {
+            std::string msg = "Error setting capacity (" + \
+                              to_string(_numNodes) + ") for node " \
+                              "variable at index " + to_string(varIndex) + ".";
+            Logger::error(__FILE__, __FUNCTION__, msg);
+            cerr << e.what() << endl;
+            exit(EXIT_FAILURE);
+        }
+        return v;
+    }
+
+    /*!
+     * Add a variable to the store. Its array is not allocated until 
+     * allocVar() is called for it. References to the arrays of the other 
+     * variables are invalidated.
+     *
+     * @return index of the new variable
+     */
+    GUINT addVar()
+    {
+        _vars.push_back(vector<T>());
+        return _vars.size() - 1;
+    }
+
+    /*!
+     * Free the array of a variable.
+     *
+     * @param varIndex index of the variable
+     */
+    void releaseVar(GUINT varIndex)
+    {
+        vector<T>& v = var(varIndex);
+        v.clear();
+        v.shrink_to_fit();
+    }
+
+    /*!
+     * Get the array of a variable.
+     *
+     * @param varIndex index of the variable
+     * @return the variable's array (empty if never allocated)
+     */
+    vector<T>& var(GUINT varIndex)
+    {
+        try
+        {
+            return _vars.at(varIndex);
+        }
+        catch (const std::out_of_range& e)
+        {
+            std::string msg = "Invalid index access into the node " \
+                              "variable list.";
+            Logger::error(__FILE__, __FUNCTION__, msg);
+            cerr << e.what() << endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    const vector<T>& var(GUINT varIndex) const
+    {
+        return const_cast<GNodeStore<T>*>(this)->var(varIndex);
+    }
+
+    /*!
+     * Reorder every allocated array with a gather permutation, such that
+     * new position i takes the value at old position order[i].
+     *
+     * @param order old node position for each new node position
+     */
+    void permute(const vector<GSIZET>& order)
+    {
+        if (order.size() != _numNodes)
+        {
+            std::string msg = "The size of the permutation (" + \
+                              to_string(order.size()) + ") is different " \
+                              "than the number of nodes (" + \
+                              to_string(_numNodes) + ").";
+            Logger::error(__FILE__, __FUNCTION__, msg);
+            exit(EXIT_FAILURE);
+        }
+
+        for (auto& v : _vars)
+        {
+            if (!v.empty()) { permuteArray(v, order); }
+        }
+        permuteArray(_elemLayerIDs, order);
+        permuteArray(_sortKeys, order);
+    }
+
+    /*!
+     * Print a node's sort key, element ID, and all of its allocated
+     * variables.
+     *
+     * @param i position of the node
+     * @param varNames variable names corresponding to the variable indices
+     */
+    void printNode(GSIZET i, const vector<GString>& varNames) const
+    {
+        // Print ID and layer info
+        cout << "sortID: (" << _sortKeys[i] << ") | ";
+        cout << "eID: (" << _elemLayerIDs[i] << ") | ";
+
+        // Print all variables in the node with variable name
+        for (auto v = 0u; v < _vars.size(); ++v)
+        {
+            if (!_vars[v].empty())
+            {
+                cout << varNames[v] << ": (" << _vars[v][i] << ") | ";
+            }
+        }
+        cout << endl;
+    }
+
+private:
+    /*!
+     * Reorder one array with a gather permutation.
+     */
+    template <typename U>
+    static void permuteArray(vector<U>& v, const vector<GSIZET>& order)
+    {
+        vector<U> tmp(v.size());
+        for (GSIZET i = 0; i < order.size(); ++i)
+        {
+            tmp[i] = v[order[i]];
+        }
+        v.swap(tmp);
+    }
+
+    GSIZET _numNodes;             // num nodes in the GeoFLOW volume
+    vector<vector<T>> _vars;      // one array per grid and field variable
+    vector<GSIZET> _elemLayerIDs; // GeoFLOW element layer # of each node
+    vector<GUINT> _sortKeys;      // original 2D elem (x,y ref dir) position
+                                  // each node belongs to in the GeoFLOW file
+};
+
+#endif
@@ -0,0 +1,194 @@
+//==============================================================================
+// Date        : 10/16/26 (agent)
+// Description : Records the wall time, CPU time, bytes read and written, peak
+//               memory and number of items processed for each stage of a
+//               conversion, and writes them to a JSON report along with each
+//               stage's throughput (items/s and MB/s).
+// Copyright   : Copyright 2021. Regents of the University of Colorado.
+//               All rights reserved.
+//==============================================================================
+
+#ifndef GPROFILER_H
+#define GPROFILER_H
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+#include <map>
+
+#include "gtypes.h"
+#include "logger.h"
+#include "timer.h"
+#include "pt_util.h"
+
+using namespace std;
+
+// Measurements of one stage (summed over every time the stage ran)
+struct GStageStats
+{
+    GString name;        // name of the stage
+    GSIZET calls;        // number of times the stage ran
+    GDOUBLE wallTime;    // wall clock time in seconds
+    GDOUBLE cpuTime;     // CPU time (all threads and child processes) in s
+    GSIZET bytesRead;    // bytes read from input files
+    GSIZET bytesWritten; // bytes written to output files
+    GSIZET items;        // number of items (i.e., values, nodes) processed
+    GSIZET peakRSS;      // process peak resident set size at the end of the
+                         // stage in bytes
+};
+
+class GProfiler
+{
+public:
+    GProfiler() : _active(-1), _wallStart(0), _cpuStart(0) {}
+    ~GProfiler() {}
+
+    /*!
+     * Start timing a stage. A stage that already ran is added to.
+     *
+     * @param name name of the stage
+     */
+    void start(const GString& name)
+    {
+        _active = -1;
+        for (GSIZET i = 0; i < _stages.size(); ++i)
+        {
+            if (_stages[i].name == name) { _active = i; }
+        }
+        if (_active < 0)
+        {
+            GStageStats s = {name, 0, 0, 0, 0, 0, 0, 0};
+            _active = _stages.size();
+            _stages.push_back(s);
+        }
+
+        _wallStart = Timer::getTime();
+        _cpuStart = Timer::getCPUTime();
+    }
+
+    /*!
+     * Stop timing the active stage, add its measurements and print them.
+     *
+     * @param items number of items processed by the stage
+     * @param bytesRead number of bytes read by the stage
+     * @param bytesWritten number of bytes written by the stage
+     */
+    void stop(GSIZET items = 0, GSIZET bytesRead = 0, GSIZET bytesWritten = 0)
+    {
+        if (_active < 0)
+        {
+            Logger::warning(__FILE__, __FUNCTION__, "No stage is active.");
+            return;
+        }
+
+        GStageStats& s = _stages[_active];
+        GDOUBLE wall = Timer::getTime() - _wallStart;
+        GDOUBLE cpu = Timer::getCPUTime() - _cpuStart;
+        s.calls += 1;
+        s.wallTime += wall;
+        s.cpuTime += cpu;
+        s.items += items;
+        s.bytesRead += bytesRead;
+        s.bytesWritten += bytesWritten;
+        s.peakRSS = Timer::getPeakRSS();
+        _active = -1;
+
+        if (Logger::enabled(GL_INFO))
+        {
+            ostringstream out;
+            out << "*** Stage (" << s.name << "): wall " << wall << " s | cpu "
+                << cpu << " s | items " << items << " | read " << bytesRead
+                << " B | written " << bytesWritten << " B | peak RSS "
+                << s.peakRSS / (1024 * 1024) << " MB | "
+                << itemsPerSecond(items, wall) << " items/s | "
+                << mbPerSecond(bytesRead + bytesWritten, wall) << " MB/s"
+                << endl;
+            Logger::print(GL_INFO, out.str());
+        }
+    }
+
+    /*!
+     * Get the number of items processed per second of wall time.
+     *
+     * @param items number of items processed
+     * @param wallTime wall time in seconds
+     * @return items per second (0 if no time was measured)
+     */
+    static GDOUBLE itemsPerSecond(GSIZET items, GDOUBLE wallTime)
+    {
+        return wallTime > 0 ? items / wallTime : 0;
+    }
+
+    /*!
+     * Get the number of MB (10^6 bytes) read and written per second of wall
+     * time.
+     *
+     * @param bytes number of bytes read and written
+     * @param wallTime wall time in seconds
+     * @return MB per second (0 if no time was measured)
+     */
+    static GDOUBLE mbPerSecond(GSIZET bytes, GDOUBLE wallTime)
+    {
+        return wallTime > 0 ? bytes / 1.0e6 / wallTime : 0;
+    }
+
+    // Access
+    const vector<GStageStats>& stages() const { return _stages; }
+
+    /*!
+     * Write the measurements of every stage to a JSON file.
+     *
+     * @param filename name of the JSON file
+     * @param info run information (i.e., input JSON file, rank) written as
+     *             key-value string pairs before the stages
+     */
+    void writeReport(const GString& filename,
+                     const map<GString, GString>& info) const
+    {
+        ofstream ofs(filename);
+        if (!ofs.good())
+        {
+            std::string msg = "Cannot write profile report: " + filename;
+            Logger::error(__FILE__, __FUNCTION__, msg);
+            exit(EXIT_FAILURE);
+        }
+
+        ofs << std::setprecision(9);
+        ofs << "{" << endl;
+        for (auto i : info)
+        {
+            ofs << PTUtil::quote(i.first) << ": " << PTUtil::quote(i.second)
+                << "," << endl;
+        }
+        ofs << "\"stages\":" << endl << "[" << endl;
+        for (GSIZET i = 0; i < _stages.size(); ++i)
+        {
+            const GStageStats& s = _stages[i];
+            ofs << "    {\"name\": " << PTUtil::quote(s.name) << ", "
+                << "\"calls\": " << s.calls << ", "
+                << "\"wall_time_s\": " << s.wallTime << ", "
+                << "\"cpu_time_s\": " << s.cpuTime << ", "
+                << "\"items\": " << s.items << ", "
+                << "\"bytes_read\": " << s.bytesRead << ", "
+                << "\"bytes_written\": " << s.bytesWritten << ", "
+                << "\"peak_rss_bytes\": " << s.peakRSS << ", "
+                << "\"items_per_s\": " << itemsPerSecond(s.items, s.wallTime)
+                << ", \"mb_per_s\": "
+                << mbPerSecond(s.bytesRead + s.bytesWritten, s.wallTime) << "}"
+                << (i + 1 < _stages.size() ? "," : "") << endl;
+        }
+        ofs << "]" << endl << "}" << endl;
+
+        Logger::print(GL_INFO, "Wrote profile report: " + filename);
+    }
+
+private:
+    vector<GStageStats> _stages; // measurements of each stage in run order
+    GINT _active;                // index of the stage being timed (-1 = none)
+    GDOUBLE _wallStart;          // wall time when the active stage started
+    GDOUBLE _cpuStart;           // CPU time when the active stage started
+};
+
+#endif
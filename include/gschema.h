@@ -0,0 +1,143 @@
+//==============================================================================
+// Date        : 10/16/26 (agent)
+// Description : Compiled form of the NetCDF metadata in the input JSON property
+//               tree. Dimensions and variables (with their types, dimensions,
+//               attributes and storage settings) are read from the property
+//               tree once and resolved into structs addressed by integer
+//               handles, so writing a NetCDF file does not search the tree.
+// Copyright   : Copyright 2021. Regents of the University of Colorado.
+//               All rights reserved.
+//==============================================================================
+
+#ifndef GSCHEMA_H
+#define GSCHEMA_H
+
+#include <vector>
+#include <unordered_map>
+
+#include "gtypes.h"
+#include "pt_util.h"
+
+using namespace std;
+
+// A NetCDF dimension
+struct GSchemaDimension
+{
+    GString name; // name of the dimension
+    GSIZET value; // size of the dimension (0 until set at runtime)
+};
+
+// A NetCDF variable attribute
+struct GSchemaAttribute
+{
+    GString name;  // name of the attribute
+    GString value; // value of the attribute as written in the JSON file
+    GString type;  // GeoFLOW type of the value (i.e., GString, GINT)
+};
+
+// NetCDF-4 storage settings of a variable
+struct GSchemaStorage
+{
+    GBOOL hasChunks;       // true if chunks was set in the JSON file
+    vector<GSIZET> chunks; // chunk size per dimension (0 = full dimension)
+    GUINT deflateLevel;    // deflate level (0 = off)
+    GBOOL shuffle;         // true to apply the shuffle filter
+    GINT quantizeDigits;   // significant digits to keep (0 = off)
+};
+
+// A NetCDF variable
+struct GSchemaVariable
+{
+    GString name;                        // name of the variable
+    GString type;                        // GeoFLOW type of the variable
+    vector<GUINT> dims;                  // handles of the dimensions
+    vector<GSchemaAttribute> attributes; // attributes of the variable
+    GSchemaStorage storage;              // storage settings of the variable
+};
+
+class GSchema
+{
+public:
+    GSchema() {}
+
+    /*!
+     * Compile the "dimensions" and "variables" arrays of a property tree.
+     *
+     * @param root root of a property tree with metadata; file format is JSON
+     */
+    explicit GSchema(const pt::ptree& root) { compile(root); }
+
+    ~GSchema() {}
+
+    /*!
+     * Read the "dimensions" and "variables" arrays of a property tree into
+     * dimension and variable structs. A variable or attribute type of
+     * "data_type" is replaced by the top-level "data_type" value, and a
+     * variable's storage settings are merged with the top-level "storage"
+     * object. Exits if a variable uses a dimension that is not defined.
+     *
+     * @param root root of a property tree with metadata; file format is JSON
+     */
+    void compile(const pt::ptree& root);
+
+    // Access
+    GUINT numDimensions() const { return _dims.size(); }
+    GUINT numVariables() const { return _vars.size(); }
+    const vector<GSchemaDimension>& dimensions() const { return _dims; }
+    const GSchemaDimension& dimension(GUINT handle) const;
+    const GSchemaVariable& variable(GUINT handle) const;
+    GBOOL hasDimension(const GString& name) const;
+    GBOOL hasVariable(const GString& name) const;
+
+    /*!
+     * Get the handle of a dimension. Exits if the dimension does not exist.
+     *
+     * @param name name of the dimension
+     * @return the handle of the dimension
+     */
+    GUINT dimensionHandle(const GString& name) const;
+
+    /*!
+     * Get the handle of a variable. Exits if the variable does not exist.
+     *
+     * @param name name of the variable
+     * @return the handle of the variable
+     */
+    GUINT variableHandle(const GString& name) const;
+
+    /*!
+     * Set the size of a dimension.
+     *
+     * @param handle handle of the dimension
+     * @param value size of the dimension
+     */
+    void setDimensionValue(GUINT handle, GSIZET value);
+
+private:
+    /*!
+     * Replace a type of "data_type" with the top-level "data_type" value.
+     *
+     * @param type a GeoFLOW type or "data_type"
+     * @return the GeoFLOW type
+     */
+    GString resolveType(const GString& type) const;
+
+    /*!
+     * Read the storage settings of a variable, falling back to the top-level
+     * settings for any setting that the variable does not have.
+     *
+     * @param varTree the variable's object in the "variables" array
+     * @param root root of the property tree
+     * @return the storage settings
+     */
+    GSchemaStorage readStorage(const pt::ptree& varTree,
+                               const pt::ptree& root) const;
+
+    GString _dataType;                         // top-level data_type value
+    vector<GSchemaDimension> _dims;            // dimensions in JSON order
+    vector<GSchemaVariable> _vars;             // variables in JSON order
+    unordered_map<GString, GUINT> _dimHandles; // dimension name to handle
+    unordered_map<GString, GUINT> _varHandles; // variable name to handle
+};
+
+#endif
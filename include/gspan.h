@@ -0,0 +1,84 @@
+//==============================================================================
+// Date        : 10/16/26 (agent)
+// Description : Read-only view of a contiguous run of values stored in memory
+//               owned by someone else (e.g., a memory-mapped GeoFLOW file).
+// Copyright   : Copyright 2021. Regents of the University of Colorado.
+//               All rights reserved.
+//==============================================================================
+
+#ifndef GSPAN_H
+#define GSPAN_H
+
+#include <cstring>
+
+#include "gtypes.h"
+
+using namespace std;
+
+template <class T>
+class GSpan
+{
+public:
+    GSpan() : _bytes(NULLPTR), _size(0) {}
+
+    /*!
+     * Constructor for viewing values stored in memory. The memory does not
+     * need to be aligned for type T (the data section of a 3D GeoFLOW file
+     * starts on a 4-byte boundary), so values are read with memcpy.
+     *
+     * @param bytes address of the first value
+     * @param size number of values
+     */
+    GSpan(const void* bytes, GSIZET size)
+        : _bytes(static_cast<const char*>(bytes)), _size(size) {}
+
+    ~GSpan() {}
+
+    // Access
+    GSIZET size() const { return _size; }
+    GBOOL empty() const { return _size == 0; }
+    const void* bytes() const { return _bytes; }
+
+    /*!
+     * Get a value.
+     *
+     * @param i position of the value
+     * @return the value
+     */
+    T operator[](GSIZET i) const
+    {
+        T v;
+        memcpy(&v, _bytes + i * sizeof(T), sizeof(T));
+        return v;
+    }
+
+    /*!
+     * Get a view of a sub-range of the values.
+     *
+     * @param offset position of the first value
+     * @param count number of values
+     * @return the view
+     */
+    GSpan<T> subspan(GSIZET offset, GSIZET count) const
+    {
+        return GSpan<T>(_bytes + offset * sizeof(T), count);
+    }
+
+    /*!
+     * Copy values into a buffer.
+     *
+     * @param offset position of the first value to copy
+     * @param count number of values to copy
+     * @param dst buffer of at least count values
+     */
+    void copyTo(GSIZET offset, GSIZET count, T* dst) const
+    {
+        memcpy(dst, _bytes + offset * sizeof(T), count * sizeof(T));
+    }
+
+private:
+    const char* _bytes; // address of the first value
+    GSIZET _size;       // number of values
+};
+
+#endif
@@ -1,6 +1,8 @@
 //==============================================================================
 // Date        : 3/25/21 (SG)
-// Description : Simple logger.
+// Description : Simple logger. Messages below the log level are dropped; the
+//               rest are queued and written to stdout/stderr in batches by a
+//               background thread, so logging does not block on console I/O.
 // Copyright   : Copyright 2021. Regents of the University of Colorado.
 //               All rights reserved.
 //==============================================================================
@@ -9,50 +11,291 @@
 #define LOGGER_H
 
 #include <iostream>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <utility>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <unistd.h>
 
 using namespace std;
 
+// Log levels, from least to most verbose
+enum GLogLevel {GL_ERROR=0, GL_WARNING, GL_INFO, GL_DEBUG};
+
 class Logger
 {
 public:
     Logger() {}
     ~Logger() {}
 
+    /*!
+     * Set the log level. Messages more verbose than the level are dropped.
+     *
+     * @param level log level
+     */
+    static void setLevel(GLogLevel level)
+    {
+        state().level = level;
+    }
+
+    /*!
+     * Set the log level from its name (error, warning, info or debug).
+     *
+     * @param name name of the log level
+     */
+    static void setLevel(const string& name)
+    {
+        const char* names[] = {"error", "warning", "info", "debug"};
+        for (int l = GL_ERROR; l <= GL_DEBUG; ++l)
+        {
+            if (name == names[l])
+            {
+                setLevel(static_cast<GLogLevel>(l));
+                return;
+            }
+        }
+        error(__FILE__, __FUNCTION__, "Unknown log level (" + name + "); " \
+              "use error, warning, info or debug.");
+        exit(EXIT_FAILURE);
+    }
+
+    /*!
+     * Check if messages of a log level get written. Use it to skip building
+     * messages that would be dropped.
+     *
+     * @param level log level
+     */
+    static bool enabled(GLogLevel level)
+    {
+        return level <= state().level;
+    }
+
     /*!
      * Print info message.
-     * 
+     *
      * @param file name of source file
      * @param func name of function
      * @param msg info message description
      */
     static void info(const char* file, const char* func, string msg)
     {
-        cout << "INFO [" << file << "::" << func << "()] " << msg << endl;
+        if (!enabled(GL_INFO)) { return; }
+        write(false, "INFO [" + string(file) + "::" + func + "()] " + msg);
+    }
+
+    /*!
+     * Print debug message.
+     *
+     * @param file name of source file
+     * @param func name of function
+     * @param msg debug message description
+     */
+    static void debug(const char* file, const char* func, string msg)
+    {
+        if (!enabled(GL_DEBUG)) { return; }
+        write(false, "DEBUG [" + string(file) + "::" + func + "()] " + msg);
+    }
+
+    /*!
+     * Print a message without a prefix (i.e., progress or a line of a
+     * listing).
+     *
+     * @param level log level of the message
+     * @param msg message
+     */
+    static void print(GLogLevel level, string msg)
+    {
+        if (!enabled(level)) { return; }
+        write(false, msg);
     }
 
      /*!
-     * Print errror message.
-     * 
+     * Print errror message. Errors are always printed, and the log is
+     * flushed since the program usually exits next.
+     *
      * @param file name of source file
      * @param func name of function
      * @param msg error message description
      */
     static void error(const char* file, const char* func, string msg)
     {
-        cerr << "ERROR [" << file << "::" << func << "()] " << msg << endl;
+        write(true, "ERROR [" + string(file) + "::" + func + "()] " + msg);
+        flush();
     }
 
     /*!
      * Print warning message.
-     * 
+     *
      * @param file name of source file
      * @param func name of function
      * @param msg warning message description
      */
     static void warning(const char* file, const char* func, string msg)
     {
-        cerr << "WARNING [" << file << "::" << func << "()] " << msg << endl;
+        if (!enabled(GL_WARNING)) { return; }
+        write(true, "WARNING [" + string(file) + "::" + func + "()] " + msg);
+    }
+
+    /*!
+     * Wait until every queued message is written. Call before writing to
+     * cout directly and before forking.
+     */
+    static void flush()
+    {
+        LogState& s = state();
+        if (direct(s))
+        {
+            cout.flush();
+            cerr.flush();
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock(s.mutex);
+        s.drained.wait(lock, [&s] { return s.queue.empty() && !s.writing; });
+        if (s.stopped)
+        {
+            cout.flush();
+            cerr.flush();
+        }
+    }
+
+private:
+    // A queued message: (true if it goes to stderr, text)
+    typedef pair<bool, string> LogLine;
+
+    // Logger state shared by all threads
+    struct LogState
+    {
+        LogState() : level(GL_WARNING), pid(getpid()), started(false),
+                     writing(false), stopped(false) {}
+
+        GLogLevel level;                // messages above it are dropped
+        pid_t pid;                      // process that owns the writer
+        bool started;                   // true once the writer is running
+        bool writing;                   // true while a batch is written
+        bool stopped;                   // true once the writer stops
+        vector<LogLine> queue;          // messages waiting to be written
+        std::mutex mutex;               // guards the fields above
+        std::condition_variable ready;  // signals queued messages
+        std::condition_variable drained;// signals an empty queue
+        std::thread writer;             // writes queued messages
+    };
+
+    /*!
+     * Get the logger state. It is never destroyed: a forked child that exits
+     * only has copies of the parent's writer thread, mutex and condition
+     * variables, and destroying them would abort (joinable thread) or block
+     * (condition variable the writer waits on). The writer is stopped at
+     * exit by stop() instead.
+     */
+    static LogState& state()
+    {
+        static LogState* s = create();
+        return *s;
+    }
+
+    static LogState* create()
+    {
+        LogState* s = new LogState();
+        atexit(stop);
+        return s;
+    }
+
+    /*!
+     * Write the remaining messages and stop the writer thread at exit. Does
+     * nothing in a forked child, which writes its messages directly.
+     */
+    static void stop()
+    {
+        LogState& s = state();
+        if (direct(s)) { return; }
+
+        {
+            std::lock_guard<std::mutex> lock(s.mutex);
+            s.stopped = true;
+        }
+        s.ready.notify_one();
+        if (s.started) { s.writer.join(); }
+    }
+
+    /*!
+     * Check if messages are written directly instead of queued, which is the
+     * case in a forked child: it has no writer thread and must not touch the
+     * parent's mutex.
+     */
+    static bool direct(LogState& s)
+    {
+        return s.pid != getpid();
+    }
+
+    /*!
+     * Queue a message for the writer thread, starting it if needed.
+     *
+     * @param toErr true to write to stderr, false for stdout
+     * @param msg message
+     */
+    static void write(bool toErr, const string& msg)
+    {
+        LogState& s = state();
+        if (direct(s))
+        {
+            (toErr ? cerr : cout) << msg << '\n';
+            return;
+        }
+
+        {
+            // Once the writer stopped at exit, write the message directly
+            std::lock_guard<std::mutex> lock(s.mutex);
+            if (s.stopped)
+            {
+                (toErr ? cerr : cout) << msg << '\n';
+                return;
+            }
+            s.queue.push_back(LogLine(toErr, msg));
+            if (!s.started)
+            {
+                s.writer = std::thread(writerLoop);
+                s.started = true;
+            }
+        }
+        s.ready.notify_one();
+    }
+
+    /*!
+     * Write queued messages in batches, flushing the streams once per batch,
+     * until the program exits.
+     */
+    static void writerLoop()
+    {
+        LogState& s = state();
+        vector<LogLine> batch;
+        std::unique_lock<std::mutex> lock(s.mutex);
+        while (true)
+        {
+            s.ready.wait(lock, [&s] { return !s.queue.empty() || s.stopped; });
+            if (s.queue.empty() && s.stopped) { break; }
+
+            batch.swap(s.queue);
+            s.writing = true;
+            lock.unlock();
+
+            for (const auto& l : batch)
+            {
+                (l.first ? cerr : cout) << l.second << '\n';
+            }
+            cout.flush();
+            cerr.flush();
+            batch.clear();
+
+            lock.lock();
+            s.writing = false;
+            s.drained.notify_all();
+        }
+        s.drained.notify_all();
     }
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -12,6 +12,9 @@
 #include <vector>
 #include <array>
 
+#include "gtypes.h"
+#include "logger.h"
+
 using namespace std;
 
 class MathUtil
@@ -88,6 +91,34 @@ public:
      */
     template <typename T>
     static array<T, 3> xyzToLatLonRadius(array<T, 3> pos);
+
+    /*!
+     * Compute lat,lon,radius for a batch of 3D Cartesian coordinates stored 
+     * in contiguous arrays. The center point of the sphere is assumed to be 
+     * (0, 0, 0). The radius and normalization pass and the degree 
+     * conversion pass are branch-free loops over contiguous arrays that the 
+     * compiler vectorizes; asin/atan2 are called per point in between.
+     * 
+     * Accuracy: the same IEEE operations are done in the same order as the 
+     * single-point xyzToLatLonRadius(), so lat, lon and radius match it 
+     * exactly (0 ULP tolerance). This relies on the compiler not fusing 
+     * x*x + y*y + z*z into multiply-adds in only one of the two, which the 
+     * Makefiles prevent with -ffp-contract=off (with contraction, radius 
+     * can differ by 2 ULP and latitudes near the poles by far more).
+     * 
+     * @param n number of coordinates
+     * @param x,y,z Cartesian coordinates (n values each)
+     * @param lat,lon,rad computed lat,lon (degrees) and radius (n values each)
+     * @return number of coordinates with magnitude 0 (their lat,lon are NaN)
+     */
+    template <typename T>
+    static GSIZET xyzToLatLonRadius(GSIZET n, 
+                                    const T* __restrict__ x, 
+                                    const T* __restrict__ y, 
+                                    const T* __restrict__ z,
+                                    T* __restrict__ lat, 
+                                    T* __restrict__ lon, 
+                                    T* __restrict__ rad);
 };
 
 #include "../src/math_util.ipp"
@@ -0,0 +1,144 @@
+//==============================================================================
+// Date        : 10/16/26 (agent)
+// Description : MPI helper functions. Without GEOFLOW_USE_MPI the program runs
+//               as a single rank and the functions do nothing.
+// Copyright   : Copyright 2021. Regents of the University of Colorado.
+//               All rights reserved.
+//==============================================================================
+
+#ifndef MPIUTIL_H
+#define MPIUTIL_H
+
+#include <vector>
+#include <climits>
+#include <algorithm>
+
+#ifdef GEOFLOW_USE_MPI
+#include <mpi.h>
+#endif
+
+#include "gtypes.h"
+
+using namespace std;
+
+class MPIUtil
+{
+public:
+    MPIUtil() {}
+    ~MPIUtil() {}
+
+    /*!
+     * Initialize MPI.
+     *
+     * @param argc pointer to the number of command line arguments
+     * @param argv pointer to the command line arguments
+     */
+    static void init(int* argc, char*** argv)
+    {
+#ifdef GEOFLOW_USE_MPI
+        MPI_Init(argc, argv);
+#endif
+    }
+
+    /*!
+     * Finalize MPI.
+     */
+    static void finalize()
+    {
+#ifdef GEOFLOW_USE_MPI
+        MPI_Finalize();
+#endif
+    }
+
+    /*!
+     * Get the rank of this process.
+     *
+     * @return the rank (0 without MPI)
+     */
+    static GUINT rank()
+    {
+#ifdef GEOFLOW_USE_MPI
+        int r = 0;
+        MPI_Comm_rank(MPI_COMM_WORLD, &r);
+        return r;
+#else
+        return 0;
+#endif
+    }
+
+    /*!
+     * Get the number of ranks.
+     *
+     * @return the number of ranks (1 without MPI)
+     */
+    static GUINT size()
+    {
+#ifdef GEOFLOW_USE_MPI
+        int s = 1;
+        MPI_Comm_size(MPI_COMM_WORLD, &s);
+        return s;
+#else
+        return 1;
+#endif
+    }
+
+    /*!
+     * Wait for all ranks.
+     */
+    static void barrier()
+    {
+#ifdef GEOFLOW_USE_MPI
+        MPI_Barrier(MPI_COMM_WORLD);
+#endif
+    }
+
+    /*!
+     * Copy a trivially copyable value from rank 0 to all ranks.
+     *
+     * @param value the value to send (rank 0) or receive (other ranks)
+     */
+    template <typename U>
+    static void broadcast(U& value)
+    {
+        broadcastBytes(&value, sizeof(U));
+    }
+
+    /*!
+     * Copy a vector of trivially copyable values from rank 0 to all ranks.
+     * The vector gets resized on the receiving ranks.
+     *
+     * @param values the values to send (rank 0) or receive (other ranks)
+     */
+    template <typename U>
+    static void broadcast(vector<U>& values)
+    {
+        GSIZET n = values.size();
+        broadcast(n);
+        values.resize(n);
+        broadcastBytes(values.data(), n * sizeof(U));
+    }
+
+    /*!
+     * Copy bytes from rank 0 to all ranks, in pieces small enough for the
+     * int count of MPI_Bcast.
+     *
+     * @param data address of the bytes
+     * @param nBytes number of bytes
+     */
+    static void broadcastBytes(void* data, GSIZET nBytes)
+    {
+#ifdef GEOFLOW_USE_MPI
+        char* bytes = static_cast<char*>(data);
+        for (GSIZET offset = 0; offset < nBytes; offset += INT_MAX)
+        {
+            int count = std::min<GSIZET>(INT_MAX, nBytes - offset);
+            MPI_Bcast(bytes + offset, count, MPI_BYTE, 0, MPI_COMM_WORLD);
+        }
+#else
+        (void)data;
+        (void)nBytes;
+#endif
+    }
+};
+
+#endif
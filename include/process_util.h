@@ -0,0 +1,147 @@
+//==============================================================================
+// Date        : 10/16/26 (agent)
+// Description : Process helper functions.
+// Copyright   : Copyright 2021. Regents of the University of Colorado.
+//               All rights reserved.
+//==============================================================================
+
+#ifndef PROCESSUTIL_H
+#define PROCESSUTIL_H
+
+#include <vector>
+#include <functional>
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "gtypes.h"
+#include "logger.h"
+
+using namespace std;
+
+class ProcessUtil
+{
+public:
+    ProcessUtil() {}
+    ~ProcessUtil() {}
+
+    /*!
+     * Run each task in its own forked child process, with up to
+     * numProcesses children running at a time, and wait for all of them.
+     * A child sees a copy-on-write snapshot of the parent's memory, so tasks
+     * can read any data the parent holds but their writes to memory are not
+     * seen by the parent. Libraries that are not thread-safe (i.e., HDF5
+     * under NetCDF-4) are safe to use in every child as long as the parent
+     * has no file open in them. Tasks run in the calling process when
+     * numProcesses is 1 or there is only one task. Exits if any task fails.
+     *
+     * @param tasks tasks to run
+     * @param numProcesses max number of child processes at a time
+     */
+    static void runInProcesses(const vector<std::function<void()>>& tasks,
+                               GUINT numProcesses)
+    {
+        if (numProcesses <= 1 || tasks.size() <= 1)
+        {
+            for (const auto& t : tasks) { t(); }
+            return;
+        }
+
+        // Flush queued and buffered output so it is not repeated by every 
+        // child
+        Logger::flush();
+        cout.flush();
+        cerr.flush();
+        fflush(NULL);
+
+        GSIZET next = 0;
+        GSIZET running = 0;
+        GSIZET failed = 0;
+        while (next < tasks.size() || running > 0)
+        {
+            // Start children until the limit is reached (no new children
+            // are started once a task has failed)
+            while (failed == 0 && running < numProcesses &&
+                   next < tasks.size())
+            {
+                pid_t pid = fork();
+                if (pid < 0)
+                {
+                    std::string msg = "Cannot fork a process: " + \
+                                      GString(strerror(errno));
+                    Logger::error(__FILE__, __FUNCTION__, msg);
+                    exit(EXIT_FAILURE);
+                }
+                if (pid == 0)
+                {
+                    runChild(tasks[next]);
+                }
+                ++running;
+                ++next;
+            }
+            if (running == 0)
+            {
+                break;
+            }
+
+            // Wait for any child to finish
+            int status = 0;
+            if (waitpid(-1, &status, 0) < 0)
+            {
+                std::string msg = "Error waiting for a child process: " + \
+                                  GString(strerror(errno));
+                Logger::error(__FILE__, __FUNCTION__, msg);
+                exit(EXIT_FAILURE);
+            }
+            --running;
+            if (WIFSIGNALED(status))
+            {
+                std::string msg = "A child process was ended by signal " + \
+                                  to_string(WTERMSIG(status)) + ".";
+                Logger::error(__FILE__, __FUNCTION__, msg);
+            }
+            if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS)
+            {
+                ++failed;
+            }
+        }
+
+        if (failed > 0)
+        {
+            std::string msg = to_string(failed) + " child process(es) " \
+                              "failed.";
+            Logger::error(__FILE__, __FUNCTION__, msg);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+private:
+    /*!
+     * Run a task in a child process and end the child. _exit is used so the
+     * parent's exit handlers and static destructors are not run twice.
+     */
+    static void runChild(const std::function<void()>& task)
+    {
+        int rc = EXIT_SUCCESS;
+        try
+        {
+            task();
+        }
+        catch (const std::exception& e)
+        {
+            Logger::error(__FILE__, __FUNCTION__, GString(e.what()));
+            rc = EXIT_FAILURE;
+        }
+        Logger::flush();
+        cout.flush();
+        cerr.flush();
+        fflush(NULL);
+        _exit(rc);
+    }
+};
+
+#endif
@@ -9,6 +9,8 @@
 #define PTUTIL_H
 
 #include <iostream>
+#include <sstream>
+#include <iomanip>
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/json_parser.hpp>
 #include <boost/foreach.hpp>
@@ -35,7 +37,7 @@ public:
     {
         try
         {
-            cout << "Reading JSON file: " << filename << endl;
+            Logger::print(GL_INFO, "Reading JSON file: " + filename);
             pt::read_json(filename, root);
         }
         catch (const boost::property_tree::json_parser_error& e)
@@ -111,6 +113,30 @@ public:
         }
     }
 
+    /*!
+     * Get the value of an optional key from the property tree.
+     * 
+     * @param tree a tree in the property tree
+     * @param key name of the key to find
+     * @param defaultValue value to return if the key does not exist
+     * @return value of key, or defaultValue if the key is not found
+     */
+    template <typename T>
+    static T getValue(const pt::ptree& tree, const GString& key, 
+                      const T& defaultValue)
+    {
+        try
+        {
+            return tree.get<T>(key, defaultValue);
+        }
+        catch (const boost::property_tree::ptree_error& e)
+        {
+            std::string msg = "Error getting value: " + GString(e.what());
+            Logger::error(__FILE__, __FUNCTION__, msg);
+            exit(EXIT_FAILURE);
+        }
+    }
+
     /*!
      * Get the values in an array in the property tree.
      * 
@@ -197,6 +223,54 @@ public:
             exit(EXIT_FAILURE);
         }
     }
+
+    /*!
+     * Serialize a tree of the property tree (its value and all its keys and 
+     * values, in order) to a compact string, i.e., to compare trees.
+     * 
+     * @param tree a tree in the property tree
+     * @return the serialized tree
+     */
+    static GString toString(const pt::ptree& tree)
+    {
+        GString s = tree.data() + "{";
+        BOOST_FOREACH (const pt::ptree::value_type& t, tree)
+        {
+            s += t.first + ":" + toString(t.second) + ",";
+        }
+        return s + "}";
+    }
+
+    /*!
+     * Quote a string as a JSON string, escaping quotes, backslashes and 
+     * control characters, for JSON written without a property tree.
+     *
+     * @param s the string
+     * @return the quoted and escaped string
+     */
+    static GString quote(const GString& s)
+    {
+        ostringstream oss;
+        oss << "\"";
+        for (auto c : s)
+        {
+            if (c == '"' || c == '\\')
+            {
+                oss << '\\' << c;
+            }
+            else if ((unsigned char)c < 0x20)
+            {
+                oss << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+                    << (int)c << std::dec;
+            }
+            else
+            {
+                oss << c;
+            }
+        }
+        oss << "\"";
+        return oss.str();
+    }
 };
                       
 #endif
\ No newline at end of file
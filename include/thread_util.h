@@ -0,0 +1,91 @@
+//==============================================================================
+// Date        : 10/16/26 (agent)
+// Description : Thread helper functions.
+// Copyright   : Copyright 2021. Regents of the University of Colorado.
+//               All rights reserved.
+//==============================================================================
+
+#ifndef THREADUTIL_H
+#define THREADUTIL_H
+
+#include <vector>
+#include <thread>
+#include <functional>
+#include <algorithm>
+
+#include "gtypes.h"
+
+using namespace std;
+
+class ThreadUtil
+{
+public:
+    ThreadUtil() {}
+    ~ThreadUtil() {}
+
+    /*!
+     * Get the number of threads to use for a loop, one per available core 
+     * but no more than needed to give each thread a minimum amount of work.
+     * 
+     * @param n number of loop iterations
+     * @param minPerThread minimum number of iterations per thread
+     * @return number of threads (at least 1)
+     */
+    static GSIZET numThreads(GSIZET n, GSIZET minPerThread)
+    {
+        GSIZET nCores = std::max(1u, std::thread::hardware_concurrency());
+        GSIZET nWork = std::max<GSIZET>(1, n / std::max<GSIZET>(1, minPerThread));
+        return std::min(nCores, nWork);
+    }
+
+    /*!
+     * Split the range [0, n) into contiguous chunks, one per thread, and 
+     * call func(begin, end) for each chunk. The calling thread runs the 
+     * first chunk. func must only write to data owned by its chunk.
+     * 
+     * @param n number of loop iterations
+     * @param minPerThread minimum number of iterations per thread
+     * @param func function called with the [begin, end) range of a chunk
+     */
+    template <typename F>
+    static void parallelFor(GSIZET n, GSIZET minPerThread, F func)
+    {
+        GSIZET nThreads = numThreads(n, minPerThread);
+        GSIZET chunk = (n + nThreads - 1) / nThreads;
+
+        vector<std::thread> threads;
+        for (GSIZET t = 1; t < nThreads; ++t)
+        {
+            GSIZET begin = std::min(n, t * chunk);
+            GSIZET end = std::min(n, begin + chunk);
+            threads.push_back(std::thread(func, begin, end));
+        }
+        func(GSIZET(0), std::min(n, chunk));
+
+        for (auto& t : threads)
+        {
+            t.join();
+        }
+    }
+
+    /*!
+     * Call a set of functions concurrently, one thread per function, and 
+     * wait for all of them to finish.
+     * 
+     * @param funcs functions to call
+     */
+    static void runConcurrently(const vector<std::function<void()>>& funcs)
+    {
+        vector<std::thread> threads;
+        for (const auto& f : funcs)
+        {
+            threads.push_back(std::thread(f));
+        }
+        for (auto& t : threads)
+        {
+            t.join();
+        }
+    }
+};
+
+#endif
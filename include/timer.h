@@ -9,7 +9,11 @@
 #define TIMER_H
 
 #include <iostream>
-#include <time.h>
+#include <sstream>
+#include <chrono>
+#include <sys/resource.h>
+
+#include "logger.h"
 
 using namespace std;
 
@@ -20,13 +24,58 @@ public:
     ~Timer() {}
 
      /*!
-     * Get current CPU time. Time uses microsecond precision.
+     * Get current wall clock time (from a monotonic clock). Time uses 
+     * nanosecond precision.
      * 
      * @return current time in seconds
      */
     static double getTime()
     {
-        return (double)clock() / CLOCKS_PER_SEC;
+        using namespace std::chrono;
+        return duration<double>(steady_clock::now().time_since_epoch()).count();
+    }
+
+    /*!
+     * Get the CPU time (user and system) used so far by this process, its 
+     * threads, and its finished child processes.
+     * 
+     * @return CPU time in seconds
+     */
+    static double getCPUTime()
+    {
+        double t = 0;
+        struct rusage ru;
+        int who[] = {RUSAGE_SELF, RUSAGE_CHILDREN};
+        for (auto w : who)
+        {
+            if (getrusage(w, &ru) == 0)
+            {
+                t += ru.ru_utime.tv_sec + ru.ru_utime.tv_usec * 1e-6 + 
+                     ru.ru_stime.tv_sec + ru.ru_stime.tv_usec * 1e-6;
+            }
+        }
+        return t;
+    }
+
+    /*!
+     * Get the peak resident set size so far of this process, or of its 
+     * largest finished child process if that is larger.
+     * 
+     * @return peak resident set size in bytes
+     */
+    static size_t getPeakRSS()
+    {
+        size_t peak = 0;
+        struct rusage ru;
+        int who[] = {RUSAGE_SELF, RUSAGE_CHILDREN};
+        for (auto w : who)
+        {
+            if (getrusage(w, &ru) == 0 && size_t(ru.ru_maxrss) > peak)
+            {
+                peak = ru.ru_maxrss; // in kilobytes on Linux
+            }
+        }
+        return peak * 1024;
     }
 
     /*!
@@ -37,8 +86,12 @@ public:
     */
     static void printElapsedTime(double start, double end, string msg="")
     {
-        cout << "*** Elapsed time (" << msg << "): " << (end - start) << " s" 
-             << endl << endl;
+        if (!Logger::enabled(GL_INFO)) { return; }
+
+        ostringstream out;
+        out << "*** Elapsed time (" << msg << "): " << (end - start) << " s" 
+            << endl;
+        Logger::print(GL_INFO, out.str());
     }
 };
 
@@ -4,21 +4,45 @@
 //             All rights reserved.
 //==============================================================================
 
+#include <sstream>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <netcdf.h>
+
 #include "g_to_netcdf.h"
 #include "logger.h"
 
-GToNetCDF::GToNetCDF(pt::ptree& ptRoot,
+GToNetCDF::GToNetCDF(const GSchema& schema,
                      const GString& ncFilename,
                      NcFile::FileMode mode)
+    : _schema(schema), _filename(ncFilename)
 {
-    Logger::info(__FILE__, __FUNCTION__, "");
-
-    // Initialize
-    _ptRoot = ptRoot;
+    // A replaced file is written under a temporary name until it is complete
+    if (mode == NcFile::FileMode::replace)
+    {
+        _tmpFilename = ncFilename + ".tmp";
+    }
 
     // Open the NetCDF file
-    cout << "Opening NetCDF file for writing: " << ncFilename << endl;
-    _nc.open(ncFilename, mode);
+    Logger::info(__FILE__, __FUNCTION__, "Opening NetCDF file for writing: " + 
+                 ncFilename);
+    _nc.open(_tmpFilename.empty() ? ncFilename : _tmpFilename, mode);
+}
+
+GToNetCDF::~GToNetCDF()
+{
+    _nc.close();
+
+    // Move the complete file to its final name (replacing any older file)
+    if (!_tmpFilename.empty() &&
+        rename(_tmpFilename.c_str(), _filename.c_str()) != 0)
+    {
+        std::string msg = "Cannot rename " + _tmpFilename + " to " + \
+                          _filename + " (" + strerror(errno) + ")";
+        Logger::error(__FILE__, __FUNCTION__, msg);
+        exit(EXIT_FAILURE);
+    }
 }
 
 NcType GToNetCDF::toNcType(const GString& gType)
@@ -29,11 +53,6 @@ NcType GToNetCDF::toNcType(const GString& gType)
     else if (gType == "GDOUBLE") { return ncDouble; }
     else if (gType == "GINT")    { return ncInt; }
     else if (gType == "GUINT")   { return ncUint; }
-    else if (gType == "data_type")
-    {
-        GString t = PTUtil::getValue<GString>(_ptRoot, "data_type");
-        return toNcType(t);
-    }
     else
     {
         std::string msg = "Unable to convert data type (" + gType + ") " + \
@@ -84,146 +103,224 @@ NcType GToNetCDF::getVariableType(const GString& varName)
     return ncVar.getType();
 }
 
-void GToNetCDF::writeDimensions()
+GSIZET GToNetCDF::getVariableSize(const NcVar& ncVar)
 {
-    Logger::info(__FILE__, __FUNCTION__, "");
-    cout << "Writing NetCDF dimensions" << endl;
+    GSIZET size = 1;
+    for (auto d : ncVar.getDims())
+    {
+        size *= d.getSize();
+    }
+    return size;
+}
 
-    pt::ptree dimArr = PTUtil::getArray(_ptRoot, "dimensions");
+void GToNetCDF::writeDimensions()
+{
+    Logger::info(__FILE__, __FUNCTION__, "Writing NetCDF dimensions");
 
-    // For each dimension in the dimensions array...
-    for (pt::ptree::iterator it = dimArr.begin(); it != dimArr.end(); ++it)
+    // For each dimension in the schema...
+    for (const auto& d : _schema.dimensions())
     {
-        // Get the values of the specified keys
-        GString name = PTUtil::getValue<GString>(it->second, "name");
-        GUINT value = PTUtil::getValue<GUINT>(it->second, "value");
-
         // For debugging
-        cout << "--- [name = " << name << ", value = " << value << "]" 
-             << endl;
+        if (Logger::enabled(GL_DEBUG))
+        {
+            Logger::print(GL_DEBUG, "--- [name = " + d.name + ", value = " + 
+                                    to_string(d.value) + "]");
+        }
         
         // Write the dimension to the NetCDF file. The dimension gets written 
         // in the form: dimName = dimValue
-        _nc.addDim(name, value);
+        _nc.addDim(d.name, d.value);
     }
 }
 
 void GToNetCDF::writeVariableDefinition(const GString& varName)
 {
-    Logger::info(__FILE__, __FUNCTION__, "");
-    cout << "Writing NetCDF variable definition for: " << varName << endl;
+    writeVariableDefinition(_schema.variableHandle(varName));
+}
 
-    pt::ptree varArr = PTUtil::getArray(_ptRoot, "variables");
+void GToNetCDF::writeVariableDefinition(GUINT handle)
+{
+    const GSchemaVariable& var = _schema.variable(handle);
 
-    // For each variable in the variables array...
-    for (pt::ptree::iterator it = varArr.begin(); it != varArr.end(); ++it)
-    {
-        // Get the value of the specified key
-        GString name = PTUtil::getValue<GString>(it->second, "name");
+    Logger::info(__FILE__, __FUNCTION__, "Writing NetCDF variable " \
+                 "definition for: " + var.name);
 
-        // If the input variable is found...
-        if (name == varName)
-        {
-            // Get the values of the specified keys
-            GString type = PTUtil::getValue<GString>(it->second, "type");
-            pt::ptree argsArr = PTUtil::getArray(it->second, "args");
-            vector<GString> args = PTUtil::getValues<GString>(argsArr);
+    // Convert the GeoFLOW type to an NcType
+    NcType ncType = toNcType(var.type);
 
-            // Convert the GeoFLOW type to an NcType
-            NcType ncType = toNcType(type);
+    // Collect the dimensions of the variable
+    vector<NcDim> ncDims;
+    for (auto d : var.dims)
+    {
+        ncDims.push_back(_nc.getDim(_schema.dimension(d).name));
+    }
 
-            // Collect the args into a vector of NetCDF dimensions
-            vector<NcDim> ncDims;
-            for (auto a : args)
-            {
-               ncDims.push_back(_nc.getDim(a));
-            }
-        
-            // Write the variable definition to the NetCDF file. The 
-            // definition gets written in the form: 
-            // varType varName(dim1, dim2, ...)
-            _nc.addVar(name, ncType, ncDims);
-
-            // For debugging
-            cout << "--- [name = " << name << ", type = " << type << ", " 
-                 << "args = ";
-            for (auto a : args)
-            {
-                cout << a << ",";
-            }
-            cout << "]" << endl;
+    // Write the variable definition to the NetCDF file. The definition gets 
+    // written in the form: varType varName(dim1, dim2, ...)
+    NcVar ncVar = _nc.addVar(var.name, ncType, ncDims);
+
+    // Set the variable's chunk shape and compression filters
+    writeVariableStorage(ncVar, var);
 
-            // Found the input variable - exit loop
-            return;
+    // For debugging
+    if (Logger::enabled(GL_DEBUG))
+    {
+        GString msg = "--- [name = " + var.name + ", type = " + var.type + 
+                      ", args = ";
+        for (auto d : var.dims)
+        {
+            msg += _schema.dimension(d).name + ",";
         }
+        Logger::print(GL_DEBUG, msg + "]");
     }
-
-    // Reached error state - could not find the input variable
-    std::string msg = "Could not find the variable (" + varName + ") in the " \
-                      "property tree.";
-    Logger::error(__FILE__, __FUNCTION__, msg);
-    exit(EXIT_FAILURE);
 }
 
-void GToNetCDF::writeVariableAttributes(const GString& varName)
+void GToNetCDF::writeVariableStorage(const NcVar& ncVar, 
+                                     const GSchemaVariable& var)
 {
-    Logger::info(__FILE__, __FUNCTION__, "");
-    cout << "Writing NetCDF variable attributes for: " << varName << endl;
+    // Scalar variables have no chunks or filters
+    if (var.dims.empty())
+    {
+        return;
+    }
+
+    const GSchemaStorage& st = var.storage;
+    GUINT deflateLevel = st.deflateLevel;
+    GBOOL shuffle = st.shuffle;
+    GINT quantizeDigits = st.quantizeDigits;
+
+    // Default chunk shape is one slice along the meshLayers and time 
+    // dimensions by the full size of every other dimension (i.e., one 2D 
+    // mesh layer)
+    vector<GSIZET> chunks;
+    for (auto d : var.dims)
+    {
+        const GSchemaDimension& dim = _schema.dimension(d);
+        GBOOL isSlice = (dim.name == "meshLayers" || dim.name == "time");
+        chunks.push_back(isSlice ? 1 : dim.value);
+    }
 
-    pt::ptree varArr = PTUtil::getArray(_ptRoot, "variables");
+    // Override the default chunk shape with the chunks array, where a value 
+    // of 0 means the full size of that dimension
+    if (st.hasChunks)
+    {
+        if (st.chunks.size() != var.dims.size())
+        {
+            std::string msg = "The number of chunk sizes (" + \
+                              to_string(st.chunks.size()) + ") for " \
+                              "variable (" + var.name + ") is different " \
+                              "than its number of dimensions (" + \
+                              to_string(var.dims.size()) + ").";
+            Logger::error(__FILE__, __FUNCTION__, msg);
+            exit(EXIT_FAILURE);
+        }
+
+        for (GSIZET i = 0; i < chunks.size(); ++i)
+        {
+            GSIZET dimSize = _schema.dimension(var.dims[i]).value;
+            GSIZET chunk = st.chunks[i];
+            chunks[i] = (chunk == 0 || chunk > dimSize) ? dimSize : chunk;
+        }
+    }
 
-    // For each variable in the variables array...
-    for (pt::ptree::iterator itVar = varArr.begin();
-         itVar != varArr.end(); 
-         ++itVar)
+    // A chunk dimension can't be 0 for an empty NetCDF dimension
+    for (auto& c : chunks)
     {
-        // Get the value of the specified key
-        GString name = PTUtil::getValue<GString>(itVar->second, "name");
+        c = std::max(c, GSIZET(1));
+    }
 
-        // If the input variable is found...
-        if (name == varName)
+    ncVar.setChunking(NcVar::nc_CHUNKED, chunks);
+    if (deflateLevel > 0 || shuffle)
+    {
+        if (deflateLevel > 9)
         {
-            // Get the varialble's attributes array
-            pt::ptree attArr = PTUtil::getArray(itVar->second, "attributes");
+            std::string msg = "The deflate level (" + \
+                              to_string(deflateLevel) + ") for variable (" + \
+                              ncVar.getName() + ") must be from 0 to 9.";
+            Logger::error(__FILE__, __FUNCTION__, msg);
+            exit(EXIT_FAILURE);
+        }
+        ncVar.setCompression(shuffle, deflateLevel > 0, deflateLevel);
+    }
 
-            // For each attribute in the attributes array...
-            for (pt::ptree::iterator itAtt = attArr.begin();
-                 itAtt != attArr.end();
-                 ++itAtt)
+    // Lossy quantization keeps quantizeDigits significant decimal digits so 
+    // the deflate filter compresses the remaining bits well. It is only 
+    // supported for floating point variables by netCDF-C 4.9 and later.
+    if (quantizeDigits > 0)
+    {
+        NcType ncType = ncVar.getType();
+        if (ncType != ncFloat && ncType != ncDouble)
+        {
+            Logger::warning(__FILE__, __FUNCTION__, "Quantization is only " \
+                            "supported for floating point variables; " \
+                            "ignoring it for variable: " + ncVar.getName());
+        }
+        else
+        {
+#ifdef NC_QUANTIZE_BITGROOM
+            int status = nc_def_var_quantize(ncVar.getParentGroup().getId(),
+                                             ncVar.getId(),
+                                             NC_QUANTIZE_BITGROOM,
+                                             quantizeDigits);
+            if (status != NC_NOERR)
             {
-                // Get the values of the specified keys
-                GString name = PTUtil::getValue<GString>(itAtt->second, "name");
-                GString value = PTUtil::getValue<GString>(itAtt->second, "value");
-                GString gType = "GString"; // default type for an attribute value
-
-                // If a type key is specified for this attribute, get the value
-                if (PTUtil::findKey(itAtt->second, "type"))
-                {
-                    gType = PTUtil::getValue<GString>(itAtt->second, "type");
-                }
-
-                // Get the NetCDF variable whose attributes we are iterating on
-                GString varName = PTUtil::getValue<GString>(itVar->second, "name");
-                NcVar ncVar = _nc.getVar(varName);
-
-                // Write the variable's attribute to the NetCDF file. The 
-                // attribute gets written in the form: 
-                // var_name:att_name = att_value
-                putAttribute(ncVar, name, value, toNcType(gType));
-
-                // For debugging
-                cout << "--- [name = " << name << ", value = " << value 
-                     << ", gtype = " << gType << "]" << endl;
+                std::string msg = "Error setting quantization for variable " \
+                                  "(" + ncVar.getName() + "): " + \
+                                  GString(nc_strerror(status));
+                Logger::error(__FILE__, __FUNCTION__, msg);
+                exit(EXIT_FAILURE);
             }
+#else
+            Logger::warning(__FILE__, __FUNCTION__, "This NetCDF library " \
+                            "does not support quantization; ignoring it for " \
+                            "variable: " + ncVar.getName());
+#endif
+        }
+    }
 
-            // Found variable - exit loop
-            return;
+    // For debugging
+    if (Logger::enabled(GL_DEBUG))
+    {
+        ostringstream msg;
+        msg << "--- [storage: chunks = ";
+        for (auto c : chunks)
+        {
+            msg << c << ",";
         }
+        msg << " shuffle = " << shuffle << ", deflate_level = " 
+            << deflateLevel << ", quantize_digits = " << quantizeDigits 
+            << "]";
+        Logger::print(GL_DEBUG, msg.str());
     }
+}
+
+void GToNetCDF::writeVariableAttributes(const GString& varName)
+{
+    writeVariableAttributes(_schema.variableHandle(varName));
+}
+
+void GToNetCDF::writeVariableAttributes(GUINT handle)
+{
+    const GSchemaVariable& var = _schema.variable(handle);
+
+    Logger::info(__FILE__, __FUNCTION__, "Writing NetCDF variable " \
+                 "attributes for: " + var.name);
+
+    // Get the NetCDF variable whose attributes we are writing
+    NcVar ncVar = _nc.getVar(var.name);
+
+    // For each attribute of the variable...
+    for (const auto& att : var.attributes)
+    {
+        // Write the variable's attribute to the NetCDF file. The attribute 
+        // gets written in the form: var_name:att_name = att_value
+        putAttribute(ncVar, att.name, att.value, toNcType(att.type));
 
-    // Reached error state - could not find the input variable
-    std::string msg = "Could not find the variable name (" + varName + ") " \
-                      "in the property tree.";
-    Logger::error(__FILE__, __FUNCTION__, msg);
-    exit(EXIT_FAILURE);
-}
\ No newline at end of file
+        // For debugging
+        if (Logger::enabled(GL_DEBUG))
+        {
+            Logger::print(GL_DEBUG, "--- [name = " + att.name + ", value = " + 
+                                    att.value + ", gtype = " + att.type + "]");
+        }
+    }
+}
@@ -5,12 +5,23 @@
 //==============================================================================
 
 #include <fstream>
+#include <sstream>
 #include <dirent.h>
 #include <sys/stat.h>
 #include <algorithm>
+#include <numeric>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <limits>
 
 #include "gfile_reader.h"
+#include "gmapped_file_reader.h"
+#include "gmanifest.h"
 #include "math_util.h"
+#include "thread_util.h"
+#include "mpi_util.h"
 #include "logger.h"
 #include "timer.h"
 
@@ -22,20 +33,32 @@ GDataConverter<T>::GDataConverter(const GString& ptFilename)
     // Initialize
     _ptFilename = ptFilename;
     _nc = 0;
+    _gridFingerprint = 0;
+    _lodNX = 0;
+    _lodNY = 0;
 
-    // Load the property tree
+    // Load the property tree, set the log level (warnings and errors only 
+    // by default) and compile its NetCDF dimensions and variables
     PTUtil::readJSONFile(_ptFilename, _ptRoot);
+    Logger::setLevel(PTUtil::getValue<GString>(_ptRoot, "log_level", 
+                                               "warning"));
+    _schema.compile(_ptRoot);
 
     // Get directory names and create output directory
     _inputDir = PTUtil::getValue<GString>(_ptRoot, "input_dir");
     _outputDir = PTUtil::getValue<GString>(_ptRoot, "output_dir");
     makeDirectory(_outputDir);
-    cout << "Input directory is: " << _inputDir << endl;
-    cout << "Output directory is: " << _outputDir << endl;    
+    for (GSIZET l = 1; l < numLODLevels(); ++l)
+    {
+        makeDirectory(_outputDir + "/" + lodLevelDir(l));
+    }
+    Logger::print(GL_INFO, "Input directory is: " + _inputDir);
+    Logger::print(GL_INFO, "Output directory is: " + _outputDir);
 
     // Get number of timesteps
     _numTimesteps = PTUtil::getValue<GUINT>(_ptRoot, "num_timesteps");
-    cout << "Num timestpes are: " << _numTimesteps << endl;
+    Logger::print(GL_INFO, "Num timestpes are: " + 
+                           to_string(_numTimesteps));
 
     // Get all variable names
     readVariableNames();
@@ -59,6 +82,291 @@ GBOOL GDataConverter<T>::do_print_nodes() const
     return PTUtil::getValue<GBOOL>(_ptRoot, "print_nodes");
 }
 
+template <class T>
+GBOOL GDataConverter<T>::do_reorder_by_permutation() const
+{
+    // Streaming needs the permutation to place each timestep's data, the 
+    // grid cache stores it in place of the sorted grid, a subset reads only 
+    // the elements it maps to the selected layers, and with MPI rank 0's 
+    // permutation is broadcast so no rank sorts the nodes
+    return do_stream_timesteps() || do_use_grid_cache() || do_subset() || 
+           MPIUtil::size() > 1 ||
+           PTUtil::getValue<GBOOL>(_ptRoot, "reorder_by_permutation", false);
+}
+
+template <class T>
+GBOOL GDataConverter<T>::do_use_mmap_reader() const
+{
+    return PTUtil::getValue<GBOOL>(_ptRoot, "use_mmap_reader", false);
+}
+
+template <class T>
+GUINT GDataConverter<T>::numReadThreads() const
+{
+    // 0 means use one thread per available core
+    GUINT n = PTUtil::getValue<GUINT>(_ptRoot, "num_read_threads", 1);
+    if (n == 0)
+    {
+        n = std::max(1u, std::thread::hardware_concurrency());
+    }
+    return n;
+}
+
+template <class T>
+GBOOL GDataConverter<T>::do_remove_duplicate_layers() const
+{
+    return PTUtil::getValue<GBOOL>(_ptRoot, "remove_duplicate_layers", false);
+}
+
+template <class T>
+GDOUBLE GDataConverter<T>::duplicateLayerTolerance() const
+{
+    return PTUtil::getValue<GDOUBLE>(_ptRoot, "duplicate_layer_tolerance", 
+                                     1.0e-12);
+}
+
+template <class T>
+GSIZET GDataConverter<T>::num2DMeshLayers() const
+{
+    if (!_lodLayers.empty())
+    {
+        return _lodLayers.size();
+    }
+    return _outLayers.empty() ? _header.n2DLayers : _outLayers.size();
+}
+
+template <class T>
+GSIZET GDataConverter<T>::num2DMeshNodes() const
+{
+    GSIZET nElems = _outElems.empty() ? _header.nElemPerElemLayer : 
+                                        _outElems.size();
+    return nElems * (_lodNodes.empty() ? _header.nNodesPer2DElem : 
+                                         _lodNodes.size());
+}
+
+template <class T>
+GSIZET GDataConverter<T>::num2DMeshFaces() const
+{
+    GSIZET nElems = _outElems.empty() ? _header.nElemPerElemLayer : 
+                                        _outElems.size();
+    return nElems * (_lodNodes.empty() ? 
+                     _header.polyOrder[0] * _header.polyOrder[1] : 
+                     (_lodNX - 1) * (_lodNY - 1));
+}
+
+template <class T>
+vector<GUINT> GDataConverter<T>::lodStrides() const
+{
+    // The output directory's stride, then the stride of each pyramid level
+    vector<GUINT> strides = {PTUtil::getValue<GUINT>(_ptRoot, "lod_stride", 
+                                                     1)};
+    auto pyramid = _ptRoot.get_child_optional("lod_pyramid");
+    if (pyramid)
+    {
+        for (const auto& a : *pyramid)
+        {
+            strides.push_back(a.second.get_value<GUINT>());
+        }
+    }
+
+    for (auto k : strides)
+    {
+        if (k == 0)
+        {
+            std::string msg = "The level of detail strides (lod_stride and " \
+                              "lod_pyramid) must be 1 or more in property " \
+                              "tree: " + _ptFilename;
+            Logger::error(__FILE__, __FUNCTION__, msg);
+            exit(EXIT_FAILURE);
+        }
+    }
+    return strides;
+}
+
+template <class T>
+GString GDataConverter<T>::lodLevelDir(GSIZET level) const
+{
+    if (level == 0)
+    {
+        return "";
+    }
+    return "lod" + to_string(lodStrides()[level]) + "/";
+}
+
+template <class T>
+vector<GUINT> GDataConverter<T>::lodIndices(GUINT polyOrder, GUINT stride)
+{
+    vector<GUINT> indices;
+    for (GUINT i = 0; i < polyOrder; i += stride)
+    {
+        indices.push_back(i);
+    }
+    indices.push_back(polyOrder);
+    return indices;
+}
+
+template <class T>
+void GDataConverter<T>::setLODLevel(GSIZET level)
+{
+    GUINT stride = lodStrides()[level];
+
+    // Pick the nodes of each 2D element to write, in the node order of the 
+    // element (x ref dir outer, y ref dir inner)
+    _lodNodes.clear();
+    _lodNX = 0;
+    _lodNY = 0;
+    if (stride > 1)
+    {
+        GUINT nY = _header.polyOrder[1] + 1; // num nodes in y ref dir
+        vector<GUINT> xs = lodIndices(_header.polyOrder[0], stride);
+        vector<GUINT> ys = lodIndices(_header.polyOrder[1], stride);
+        for (auto x : xs)
+        {
+            for (auto y : ys)
+            {
+                _lodNodes.push_back(x * nY + y);
+            }
+        }
+        _lodNX = xs.size();
+        _lodNY = ys.size();
+    }
+
+    // Pick the 2D mesh layers of a 3D grid to write: those at the same node 
+    // indices in the z ref dir of each element layer. A subset whose layers 
+    // include none of them keeps its layers.
+    _lodLayers.clear();
+    if (stride > 1 && _header.dim == 3)
+    {
+        GUINT nZ = _header.polyOrder[2] + 1; // num nodes in z ref dir
+        vector<GUINT> zs = lodIndices(_header.polyOrder[2], stride);
+        set<GUINT> keepZ(zs.begin(), zs.end());
+        GSIZET nLayers = _outLayers.empty() ? _header.n2DLayers : 
+                                              _outLayers.size();
+        for (GSIZET n = 0; n < nLayers; ++n)
+        {
+            GSIZET l = _outLayers.empty() ? n : _outLayers[n];
+            if (keepZ.count(l % nZ) != 0)
+            {
+                _lodLayers.push_back(l);
+            }
+        }
+    }
+
+    setMeshDimensions();
+}
+
+template <class T>
+void GDataConverter<T>::setMeshDimensions()
+{
+    map<GString, GSIZET> dims;
+    dims["nMeshNodes"] = num2DMeshNodes();
+    dims["nMeshFaces"] = num2DMeshFaces();
+    dims["meshLayers"] = num2DMeshLayers();
+    setDimensions(dims);
+}
+
+template <class T>
+GBOOL GDataConverter<T>::do_subset() const
+{
+    return (GBOOL)_ptRoot.get_child_optional("subset");
+}
+
+template <class T>
+GSIZET GDataConverter<T>::numReadNodes() const
+{
+    if (_readRuns.empty())
+    {
+        return _header.nNodesPerVolume;
+    }
+    GSIZET nElems = 0;
+    for (const auto& r : _readRuns)
+    {
+        nElems += r.count;
+    }
+    return nElems * _header.nNodesPerElem;
+}
+
+template <class T>
+void GDataConverter<T>::findReadLayerIDs()
+{
+    _readLayerIDs.clear();
+    if (_readRuns.empty() || !_outElems.empty())
+    {
+        return;
+    }
+    for (const auto& r : _readRuns)
+    {
+        for (GSIZET e = r.first; e < r.first + r.count; ++e)
+        {
+            _readLayerIDs.insert(GET_LOWORD(_header.elemIDs[e]));
+        }
+    }
+}
+
+template <class T>
+GUINT GDataConverter<T>::numWriterProcesses() const
+{
+    GUINT n = PTUtil::getValue<GUINT>(_ptRoot, "num_writer_processes", 1);
+    if (n == 0)
+    {
+        n = std::max(1u, std::thread::hardware_concurrency());
+    }
+    return n;
+}
+
+template <class T>
+GBOOL GDataConverter<T>::do_write_profile() const
+{
+    return PTUtil::getValue<GBOOL>(_ptRoot, "write_profile", false);
+}
+
+template <class T>
+GBOOL GDataConverter<T>::do_use_grid_cache() const
+{
+    // An incremental conversion skips the grid work along with the current 
+    // field variable files
+    return do_incremental() || 
+           PTUtil::getValue<GBOOL>(_ptRoot, "use_grid_cache", false);
+}
+
+template <class T>
+GBOOL GDataConverter<T>::do_incremental() const
+{
+    return PTUtil::getValue<GBOOL>(_ptRoot, "incremental", false);
+}
+
+template <class T>
+GSIZET GDataConverter<T>::numLayersPerWrite() const
+{
+    return PTUtil::getValue<GSIZET>(_ptRoot, "layers_per_write", 0);
+}
+
+template <class T>
+GBOOL GDataConverter<T>::do_stream_timesteps() const
+{
+    // Following converts each timestep as it appears
+    return do_follow() || 
+           PTUtil::getValue<GBOOL>(_ptRoot, "stream_timesteps", false);
+}
+
+template <class T>
+GBOOL GDataConverter<T>::do_follow() const
+{
+    return PTUtil::getValue<GBOOL>(_ptRoot, "follow", false);
+}
+
+template <class T>
+GDOUBLE GDataConverter<T>::followPollInterval() const
+{
+    return PTUtil::getValue<GDOUBLE>(_ptRoot, "follow_poll_interval", 1.0);
+}
+
+template <class T>
+GDOUBLE GDataConverter<T>::followTimeout() const
+{
+    return PTUtil::getValue<GDOUBLE>(_ptRoot, "follow_timeout", 0.0);
+}
+
 template <class T>
 void GDataConverter<T>::readVariableNames()
 {
@@ -101,56 +409,47 @@ void GDataConverter<T>::readVariableNames()
     _allVarNames.insert(std::end(_allVarNames), 
                         std::begin(_fieldVarNames), 
                         std::end(_fieldVarNames));
+    for (GUINT i = 0; i < _allVarNames.size(); ++i)
+    {
+        _varIndices[_allVarNames[i]] = i;
+    }
 
     // For debugging
-    cout << "All variable names (grid and field) are: ";
-    for (auto n : _allVarNames) { cout << n << ", "; }
-    cout << endl;
+    if (Logger::enabled(GL_DEBUG))
+    {
+        GString msg = "All variable names (grid and field) are: ";
+        for (auto n : _allVarNames) { msg += n + ", "; }
+        Logger::print(GL_DEBUG, msg);
 
-    cout << "Timestepped field variable names are: ";
-    for (auto n : _fieldVarNames) { cout << n << ", "; }
-    cout << endl;
+        msg = "Timestepped field variable names are: ";
+        for (auto n : _fieldVarNames) { msg += n + ", "; }
+        Logger::print(GL_DEBUG, msg);
+    }
 
-    cout << "Verifying nc vars corresponding to grid and field variables "
-         << "exist in the property tree." << endl;
+    Logger::print(GL_INFO, "Verifying nc vars corresponding to grid and " \
+                           "field variables exist in the property tree.");
 
     vector<GString> rootVarNames = gridVarNames;
     rootVarNames.insert(std::end(rootVarNames), 
                         std::begin(fieldVarNames), 
                         std::end(fieldVarNames));
-    pt::ptree varArr = PTUtil::getArray(_ptRoot, "variables");
 
     // For each variable in the root var names list...
     for (auto var : rootVarNames)
     {
-        GBOOL found = false;
-        // For each variable in the property tree variables array...
-        for (pt::ptree::iterator it = varArr.begin(); it != varArr.end(); ++it)
-        {
-            // Get the value of the specified key
-            GString name = PTUtil::getValue<GString>(it->second, "name");
-
-            // If the input variable is found...
-            if (name == var)
-            {
-                cout << "Found variable: " << name << endl;
-                found = true;
-                continue;
-            }
-        }
-        
-        if (found == false)
+        if (!_schema.hasVariable(var))
         {
             std::string msg = "Could not find root variable (" + var + \
                               ") in property tree: " + _ptFilename;
             Logger::error(__FILE__, __FUNCTION__, msg);
             exit(EXIT_FAILURE); 
         }
+        Logger::print(GL_DEBUG, "Found variable: " + var);
     }
 }
 
 template <class T>
-GString GDataConverter<T>::extractTimestep(GString varName)
+GString GDataConverter<T>::extractTimestep(GString varName) const
 {
     auto npos = varName.find('.');
     if (npos != string::npos)
@@ -167,7 +466,7 @@ GString GDataConverter<T>::extractTimestep(GString varName)
 }
 
 template <class T>
-GString GDataConverter<T>::extractRootVarName(GString varName)
+GString GDataConverter<T>::extractRootVarName(GString varName) const
 {
     auto npos = varName.find('.');
     if (npos != string::npos)
@@ -213,14 +512,157 @@ GDataConverter<T>::~GDataConverter()
     closeNC();
 }
 
+template <class T>
+vector<GString> GDataConverter<T>::gridFilenames() const
+{
+    return {PTUtil::getValue<GString>(_ptRoot, "grid_filenames.x"),
+            PTUtil::getValue<GString>(_ptRoot, "grid_filenames.y"),
+            PTUtil::getValue<GString>(_ptRoot, "grid_filenames.z")};
+}
+
+template <class T>
+GSIZET GDataConverter<T>::inputFileBytes(
+                                const vector<GString>& gfFilenames) const
+{
+    return fileBytes(_inputDir, gfFilenames);
+}
+
+template <class T>
+GSIZET GDataConverter<T>::outputFileBytes(
+                                const vector<GString>& ncFilenames) const
+{
+    return fileBytes(_outputDir, ncFilenames);
+}
+
+template <class T>
+GBOOL GDataConverter<T>::loadGridCache()
+{
+    Logger::info(__FILE__, __FUNCTION__, "");
+
+    GString cacheFilename = _outputDir + "/grid.cache";
+    GGridCacheData data;
+    if (!GGridCache::read(cacheFilename, data))
+    {
+        Logger::print(GL_INFO, "No grid cache file: " + cacheFilename);
+        return false;
+    }
+    if (data.fingerprint != gridFingerprint() || data.valueBytes != sizeof(T))
+    {
+        Logger::print(GL_INFO, "The grid cache is out of date (the grid " \
+                               "files or grid settings changed)");
+        return false;
+    }
+    GManifestFile gridFile;
+    if (!GManifest::statFile(_outputDir + "/grid.nc", gridFile) ||
+        gridFile.size != data.gridFileBytes ||
+        gridFile.mtime != data.gridFileMtime)
+    {
+        Logger::print(GL_INFO, "The grid cache does not match grid.nc (it " \
+                               "is missing or changed)");
+        return false;
+    }
+
+    _header = data.header;
+    _nodes.init(_allVarNames.size(), data.numNodes);
+    _reorder.swap(data.reorder);
+    _outLayers.swap(data.outLayers);
+    _dupLayers.swap(data.dupLayers);
+    _outElems.swap(data.outElems);
+    _readRuns.swap(data.readRuns);
+    _faceNodes.swap(data.faceNodes);
+    findReadLayerIDs();
+
+    Logger::print(GL_INFO, "Loaded the grid from the grid cache file: " + 
+                           cacheFilename);
+    return true;
+}
+
+template <class T>
+void GDataConverter<T>::saveGridCache()
+{
+    Logger::info(__FILE__, __FUNCTION__, "");
+
+    GGridCacheData data;
+    data.fingerprint = gridFingerprint();
+    data.valueBytes = sizeof(T);
+    data.header = _header;
+    data.numNodes = _nodes.size();
+    data.reorder = _reorder;
+    data.outLayers = _outLayers;
+    data.dupLayers = _dupLayers;
+    data.outElems = _outElems;
+    data.readRuns = _readRuns;
+    data.faceNodes = _faceNodes;
+    GManifestFile gridFile = {"grid.nc", 0, 0};
+    GManifest::statFile(_outputDir + "/grid.nc", gridFile);
+    data.gridFileBytes = gridFile.size;
+    data.gridFileMtime = gridFile.mtime;
+    GGridCache::write(_outputDir + "/grid.cache", data);
+}
+
+template <class T>
+GSIZET GDataConverter<T>::gridFingerprint()
+{
+    if (_gridFingerprint == 0)
+    {
+        vector<GString> filenames;
+        for (const auto& f : gridFilenames())
+        {
+            filenames.push_back(_inputDir + "/" + f);
+        }
+        _gridFingerprint = GGridCache::fingerprint(filenames, gridSettings());
+    }
+    return _gridFingerprint;
+}
+
+template <class T>
+GString GDataConverter<T>::gridSettings() const
+{
+    // The grid variables' definitions, the dimensions they use and the 
+    // options that change the grid values or the layers written
+    GString settings;
+    const char* keys[] = {"data_type", "is_spherical", "grid_filenames",
+                          "grid_variable_names", "dimensions", "variables",
+                          "storage", "remove_duplicate_layers",
+                          "duplicate_layer_tolerance", "subset", 
+                          "lod_stride", "lod_pyramid"};
+    for (auto k : keys)
+    {
+        settings += GString(k) + "=";
+        auto child = _ptRoot.get_child_optional(k);
+        if (child)
+        {
+            settings += PTUtil::toString(*child);
+        }
+        settings += ";";
+    }
+    return settings;
+}
+
+template <class T>
+GSIZET GDataConverter<T>::fileBytes(const GString& dirName,
+                                    const vector<GString>& filenames) const
+{
+    GSIZET bytes = 0;
+    for (const auto& f : filenames)
+    {
+        struct stat st;
+        if (stat((dirName + "/" + f).c_str(), &st) == 0)
+        {
+            bytes += st.st_size;
+        }
+    }
+    return bytes;
+}
+
 template <class T>
 GUINT GDataConverter<T>::toVarIndex(const GString& varName)
 {
     // Find the index of the input variable name
-    auto it = std::find(_allVarNames.begin(), _allVarNames.end(), varName);
-    if (it != _allVarNames.end())
+    auto it = _varIndices.find(varName);
+    if (it != _varIndices.end())
     {
-        return it - _allVarNames.begin();
+        return it->second;
     }
     else
     {
@@ -237,8 +679,7 @@ GHeaderInfo GDataConverter<T>::readGFGridToLatLonRadNodes(
                                                     const GString& lonVarName, 
                                                     const GString& radVarName)
 {
-    Logger::info(__FILE__, __FUNCTION__, "");
-    cout << "Reading GeoFLOW grid files" << endl;
+    Logger::info(__FILE__, __FUNCTION__, "Reading GeoFLOW grid files");
 
     // Read the x,y,z GeoFLOW grid filenames from the property tree
     GString xFilename = PTUtil::getValue<GString>(_ptRoot, "grid_filenames.x");
@@ -249,68 +690,115 @@ GHeaderInfo GDataConverter<T>::readGFGridToLatLonRadNodes(
     yFilename = _inputDir + "/" + yFilename;
     zFilename = _inputDir + "/" + zFilename;
 
-    // Read the GeoFLOW x,y,z grid files (reader stores header and data)
-    GFileReader<T> x(xFilename);
-    GFileReader<T> y(yFilename);
-    GFileReader<T> z(zFilename);
-
-    // Verify data size
-    if (!(x.data().size() == y.data().size() && 
-          y.data().size() == z.data().size()))
+    // Read the GeoFLOW x,y,z grid files concurrently (reader stores header 
+    // and data) and store them in the nodes
+    if (do_use_mmap_reader())
     {
-        string msg = "The number of values in the x grid (" + \
-                     to_string(x.data().size()) + "), y grid (" + \
-                     to_string(y.data().size()) + ") and z grid (" + \
-                     to_string(z.data().size()) + ") differ.";
-
-        Logger::error(__FILE__, __FUNCTION__, msg);
-        exit(EXIT_FAILURE);
+        unique_ptr<GMappedFileReader<T>> x, y, z;
+        readGridFiles(xFilename, yFilename, zFilename, x, y, z);
+        storeLatLonRadNodes(x->header(), x->data(), y->data(), z->data(),
+                            latVarName, lonVarName, radVarName);
+    }
+    else
+    {
+        unique_ptr<GFileReader<T>> x, y, z;
+        readGridFiles(xFilename, yFilename, zFilename, x, y, z);
+        storeLatLonRadNodes(x->header(), x->data(), y->data(), z->data(),
+                            latVarName, lonVarName, radVarName);
     }
 
+    return _header;
+}
+
+template <class T>
+template <typename S>
+void GDataConverter<T>::storeLatLonRadNodes(const GHeaderInfo& header,
+                                            const S& x, const S& y, const S& z,
+                                            const GString& latVarName, 
+                                            const GString& lonVarName, 
+                                            const GString& radVarName)
+{
+    // Verify data size
+    verifyGridSize(x.size(), y.size(), z.size());
+
     // Read each x,y,z location value and element layer ID into a collection 
     // of nodes. The IDs/header are the same for each x,y,z triplet so just 
     // use the IDs/header from the x grid.
 
-    cout << "Converting x,y,z to lat,lon,r and reading GeoFLOW grid to nodes" \
-         << " (spherical coordinates)" << endl;
-
-    _nodes.clear(); // remove all elements from vector (i.e., size = 0)
-    _nodes.shrink_to_fit(); // reduce vector capacity to vector size
+    Logger::print(GL_INFO, "Converting x,y,z to lat,lon,r and reading " \
+                           "GeoFLOW grid to nodes (spherical coordinates)");
 
-    // Set the vector capacity in advance
-    GSIZET numNodes = (x.header()).nNodesPerVolume;
-    try
+    // Allocate the node arrays for the lat,lon,radius variables
+    GSIZET numNodes = header.nNodesPerVolume;
+    _nodes.init(_allVarNames.size(), numNodes);
+    if (do_reorder_by_permutation())
     {
-        _nodes.reserve(numNodes);
+        computeReorderPermutation(header);
     }
-    catch (const std::length_error& e) 
+    vector<T>& lat = _nodes.allocVar(toVarIndex(latVarName));
+    vector<T>& lon = _nodes.allocVar(toVarIndex(lonVarName));
+    vector<T>& rad = _nodes.allocVar(toVarIndex(radVarName));
+
+    Logger::print(GL_DEBUG, "_allVarNames.size() is: " + 
+                            to_string(_allVarNames.size()));
+
+    // Convert the nodes in blocks of contiguous values with the batched 
+    // lat,lon,radius kernel, splitting the blocks across threads
+    const GSIZET blockSize = 4096;
+    std::atomic<GSIZET> nZeros(0);
+    ThreadUtil::parallelFor(numNodes, 16 * blockSize, 
+                            [&](GSIZET begin, GSIZET end)
     {
-        std::string msg = "Error setting capacity for list of nodes: " + \
-                          (x.header()).nNodesPerVolume + GString(e.what());
-        Logger::error(__FILE__, __FUNCTION__, msg);
-        exit(EXIT_FAILURE);
-    }
+        vector<T> buf(6 * blockSize);
+        T* bx = &buf[0];
+        T* by = &buf[blockSize];
+        T* bz = &buf[2 * blockSize];
 
-    cout << "_allVarNames.size() is: " << _allVarNames.size() << endl;
+        // For each block of nodes in this thread's range...
+        for (GSIZET b = begin; b < end; b += blockSize)
+        {
+            GSIZET n = std::min(blockSize, end - b);
+            const T* px = blockValues(x, b, n, bx);
+            const T* py = blockValues(y, b, n, by);
+            const T* pz = blockValues(z, b, n, bz);
 
-    // For each node in the volume...
-    array<T, 3> llr;
-    for (auto i = 0u; i < numNodes; ++i)
-    {
-        llr = MathUtil::xyzToLatLonRadius<T>({x.data()[i], y.data()[i], z.data()[i]});
+            if (_reorder.empty())
+            {
+                // Write straight into the node arrays
+                nZeros += MathUtil::xyzToLatLonRadius(n, px, py, pz, 
+                                                      &lat[b], &lon[b], 
+                                                      &rad[b]);
+            }
+            else
+            {
+                // Scatter each value into its sorted position
+                T* bLat = &buf[3 * blockSize];
+                T* bLon = &buf[4 * blockSize];
+                T* bRad = &buf[5 * blockSize];
+                nZeros += MathUtil::xyzToLatLonRadius(n, px, py, pz, 
+                                                      bLat, bLon, bRad);
+                for (GSIZET i = 0; i < n; ++i)
+                {
+                    GSIZET pos = _reorder[b + i];
+                    lat[pos] = bLat[i];
+                    lon[pos] = bLon[i];
+                    rad[pos] = bRad[i];
+                }
+            }
+        }
+    });
 
-        // Add new node to list
-        _nodes.emplace_back(_allVarNames.size(),
-                            toVarIndex(latVarName), llr[0],
-                            toVarIndex(lonVarName), llr[1],
-                            toVarIndex(radVarName), llr[2],
-                            x.elementLayerIDs()[i]);
+    if (nZeros > 0)
+    {
+        string msg = "Cannot normalize " + to_string(nZeros) + " grid " \
+                     "coordinate(s) because magnitude is 0.";
+        Logger::error(__FILE__, __FUNCTION__, msg);
+        exit(EXIT_FAILURE);
     }
+    storeElemLayerIDs(header);
 
     // Save header
-    _header = x.header();
-
-    return x.header();
+    _header = header;
 }
 
 template <class T>
@@ -318,8 +806,7 @@ GHeaderInfo GDataConverter<T>::readGFGridToBoxNodes(const GString& xVarName,
                                                     const GString& yVarName, 
                                                     const GString& zVarName)
 {
-    Logger::info(__FILE__, __FUNCTION__, "");
-    cout << "Reading GeoFLOW grid files" << endl;
+    Logger::info(__FILE__, __FUNCTION__, "Reading GeoFLOW grid files");
 
     // Read the x,y,z GeoFLOW grid filenames from the property tree
     GString xFilename = PTUtil::getValue<GString>(_ptRoot, "grid_filenames.x");
@@ -330,114 +817,501 @@ GHeaderInfo GDataConverter<T>::readGFGridToBoxNodes(const GString& xVarName,
     yFilename = _inputDir + "/" + yFilename;
     zFilename = _inputDir + "/" + zFilename;
 
-    // Read the GeoFLOW x,y,z grid files (reader stores header and data)
-    GFileReader<T> x(xFilename);
-    GFileReader<T> y(yFilename);
-    GFileReader<T> z(zFilename);
-
-    // Verify data size
-    if (!(x.data().size() == y.data().size() && 
-          y.data().size() == z.data().size()))
+    // Read the GeoFLOW x,y,z grid files concurrently (reader stores header 
+    // and data) and store them in the nodes
+    if (do_use_mmap_reader())
     {
-        string msg = "The number of values in the x grid (" + \
-                     to_string(x.data().size()) + "), y grid (" + \
-                     to_string(y.data().size()) + ") and z grid (" + \
-                     to_string(z.data().size()) + ") differ.";
-
-        Logger::error(__FILE__, __FUNCTION__, msg);
-        exit(EXIT_FAILURE);
+        unique_ptr<GMappedFileReader<T>> x, y, z;
+        readGridFiles(xFilename, yFilename, zFilename, x, y, z);
+        storeBoxNodes(x->header(), x->data(), y->data(), z->data(),
+                      xVarName, yVarName, zVarName);
     }
-
+    else
+    {
+        unique_ptr<GFileReader<T>> x, y, z;
+        readGridFiles(xFilename, yFilename, zFilename, x, y, z);
+        storeBoxNodes(x->header(), x->data(), y->data(), z->data(),
+                      xVarName, yVarName, zVarName);
+    }
+
+    return _header;
+}
+
+template <class T>
+template <typename S>
+void GDataConverter<T>::storeBoxNodes(const GHeaderInfo& header,
+                                      const S& x, const S& y, const S& z,
+                                      const GString& xVarName, 
+                                      const GString& yVarName, 
+                                      const GString& zVarName)
+{
+    // Verify data size
+    verifyGridSize(x.size(), y.size(), z.size());
+
     // Read each x,y,z location value and element layer ID into a collection 
     // of nodes. The IDs/header are the same for each x,y,z triplet so just 
     // use the IDs/header from the x grid.
 
-    cout << "Reading GeoFLOW grid to nodes (box grid)" << endl;
-
-    _nodes.clear(); // remove all elements from vector (i.e., size = 0)
-    _nodes.shrink_to_fit(); // reduce vectory capacity to vector size
+    Logger::print(GL_INFO, "Reading GeoFLOW grid to nodes (box grid)");
 
-    // Set the vector capacity in advance
-    GSIZET numNodes = (x.header()).nNodesPerVolume;
-    try
+    // Store each grid file's data into its node array
+    _nodes.init(_allVarNames.size(), header.nNodesPerVolume);
+    if (do_reorder_by_permutation())
     {
-        _nodes.reserve(numNodes);
+        computeReorderPermutation(header);
     }
-    catch (const std::length_error& e) 
+    storeVar(toVarIndex(xVarName), x);
+    storeVar(toVarIndex(yVarName), y);
+    storeVar(toVarIndex(zVarName), z);
+    storeElemLayerIDs(header);
+
+    // Save header
+    _header = header;
+}
+
+template <class T>
+template <class R>
+void GDataConverter<T>::readGridFiles(const GString& xFilename,
+                                      const GString& yFilename,
+                                      const GString& zFilename,
+                                      unique_ptr<R>& x,
+                                      unique_ptr<R>& y,
+                                      unique_ptr<R>& z)
+{
+    ThreadUtil::runConcurrently({[&]() { x.reset(new R(xFilename)); },
+                                 [&]() { y.reset(new R(yFilename)); },
+                                 [&]() { z.reset(new R(zFilename)); }});
+}
+
+template <class T>
+void GDataConverter<T>::verifyGridSize(GSIZET xSize, GSIZET ySize, 
+                                       GSIZET zSize)
+{
+    if (!(xSize == ySize && ySize == zSize))
     {
-        std::string msg = "Error setting capacity for list of nodes: " + \
-                          (x.header()).nNodesPerVolume + GString(e.what());
+        string msg = "The number of values in the x grid (" + \
+                     to_string(xSize) + "), y grid (" + \
+                     to_string(ySize) + ") and z grid (" + \
+                     to_string(zSize) + ") differ.";
+
         Logger::error(__FILE__, __FUNCTION__, msg);
         exit(EXIT_FAILURE);
     }
+}
 
-    // For each node in the volume...
-    for (auto i = 0u; i < numNodes; ++i)
+template <class T>
+void GDataConverter<T>::storeElemLayerIDs(const GHeaderInfo& header)
+{
+    // Use the header's element ID array to set an element layer ID for each 
+    // node
+    vector<GSIZET>& ids = _nodes.elemLayerIDs();
+    GSIZET i = 0;
+    for (GSIZET e = 0; e < header.nElems; ++e)
     {
-        // Add new node to list
-        _nodes.emplace_back(_allVarNames.size(),
-                            toVarIndex(xVarName), x.data()[i],
-                            toVarIndex(yVarName), y.data()[i],
-                            toVarIndex(zVarName), z.data()[i],
-                            x.elementLayerIDs()[i]);
+        GSIZET id = GET_LOWORD(header.elemIDs[e]);
+        for (GSIZET j = 0; j < header.nNodesPerElem; ++j, ++i)
+        {
+            ids[_reorder.empty() ? i : _reorder[i]] = id;
+        }
     }
+}
 
-    // Save header
-    _header = x.header();
+template <class T>
+GHeaderInfo GDataConverter<T>::broadcastGrid()
+{
+    Logger::info(__FILE__, __FUNCTION__, "Broadcasting the grid from rank 0 " \
+                 "to " + to_string(MPIUtil::size()) + " ranks");
+
+    // Copy the data stored in the header; the rest is derived from it
+    MPIUtil::broadcast(_header.version);
+    MPIUtil::broadcast(_header.dim);
+    MPIUtil::broadcast(_header.nElems);
+    MPIUtil::broadcast(_header.polyOrder);
+    MPIUtil::broadcast(_header.gridType);
+    MPIUtil::broadcast(_header.timeCycle);
+    MPIUtil::broadcast(_header.timeStamp);
+    MPIUtil::broadcast(_header.hasMultVars);
+    MPIUtil::broadcast(_header.elemIDs);
+    MPIUtil::broadcast(_header.nHeaderBytes);
+    _header.deriveInfo();
+
+    // Copy the node arrays
+    GSIZET numNodes = _nodes.size();
+    MPIUtil::broadcast(numNodes);
+    if (MPIUtil::rank() != 0)
+    {
+        _nodes.init(_allVarNames.size(), numNodes);
+    }
+    MPIUtil::broadcast(_reorder);
+    MPIUtil::broadcast(_nodes.elemLayerIDs());
+    MPIUtil::broadcast(_nodes.sortKeys());
+
+    MPIUtil::broadcast(_outLayers);
+    MPIUtil::broadcast(_dupLayers);
+    MPIUtil::broadcast(_subsetLayers);
+    MPIUtil::broadcast(_outElems);
+    MPIUtil::broadcast(_readRuns);
+    findReadLayerIDs();
+
+    // For each variable rank 0 has stored (i.e., the grid variables)...
+    for (GUINT v = 0; v < _allVarNames.size(); ++v)
+    {
+        GBOOL isAllocated = !_nodes.var(v).empty();
+        MPIUtil::broadcast(isAllocated);
+        if (isAllocated)
+        {
+            MPIUtil::broadcast(_nodes.var(v));
+        }
+    }
 
-    return x.header();
+    return _header;
+}
+
+template <class T>
+vector<GString> GDataConverter<T>::localFieldVarNames() const
+{
+    GUINT rank = MPIUtil::rank();
+    GUINT size = MPIUtil::size();
+    if (size == 1)
+    {
+        return _fieldVarNames;
+    }
+
+    // Give each rank every size-th output file
+    vector<GString> names;
+    map<GString, GSIZET> timestepIndex;
+    for (GSIZET i = 0; i < _fieldVarNames.size(); ++i)
+    {
+        GSIZET file = i;
+        if (!do_write_separate_var_files())
+        {
+            GString timestep = extractTimestep(_fieldVarNames[i]);
+            file = timestepIndex.insert(make_pair(timestep, 
+                                        timestepIndex.size())).first->second;
+        }
+        if (file % size == rank)
+        {
+            names.push_back(_fieldVarNames[i]);
+        }
+    }
+    return names;
 }
 
 template <class T>
 GHeaderInfo GDataConverter<T>::readGFVariableToNodes(const GString& gfFilename,
                                                      const GString& varName)
 {
-    Logger::info(__FILE__, __FUNCTION__, "");
-    cout << "Reading GF variable to nodes: " << varName << endl;
+    Logger::info(__FILE__, __FUNCTION__, "Reading GF variable to nodes: " + 
+                 varName);
 
     // Get full output path
     GString filename = _inputDir + "/" + gfFilename;
 
-    // Read a GeoFLOW file
-    GFileReader<T> var(filename);
+    // Read a GeoFLOW file as the type its values are stored as (the node type 
+    // if unknown) and store its data into the variable's node array. A field 
+    // file has the grid's elements, so the type is told by its byte size and 
+    // the grid header; the file's own header is only read here if not.
+    GSIZET valueBytes = 0;
+    struct stat st;
+    if (stat(filename.c_str(), &st) == 0)
+    {
+        valueBytes = _header.valueBytes(st.st_size);
+    }
+    if (valueBytes == 0)
+    {
+        valueBytes = GFileReader<T>::readValueBytes(filename);
+    }
+    if (valueBytes == 0)
+    {
+        valueBytes = sizeof(T);
+    }
+    if (valueBytes == sizeof(GFLOAT))
+    {
+        return readGFVariableFile<GFLOAT>(filename, toVarIndex(varName));
+    }
+    return readGFVariableFile<GDOUBLE>(filename, toVarIndex(varName));
+}
 
-    // Verify data size
-    if (var.data().size() != _nodes.size())
+template <class T>
+template <typename U>
+GHeaderInfo GDataConverter<T>::readGFVariableFile(const GString& filename,
+                                                  GUINT varIndex)
+{
+    if (do_use_mmap_reader())
+    {
+        GMappedFileReader<U> var(filename);
+        verifyVarSize(filename, var.data().size());
+        storeVar(varIndex, var.data());
+        return var.header();
+    }
+    else if (!_readLayerIDs.empty())
+    {
+        // Read only the elements of the subset's element layers
+        GFileReader<U> var(filename, _readLayerIDs);
+        verifyVarSize(filename, var.header().nNodesPerVolume);
+        storeVar(varIndex, var.data(), true);
+        return var.header();
+    }
+    else if (!_readRuns.empty())
+    {
+        // Read only the element runs of the subset
+        GFileReader<U> var(filename, _readRuns);
+        verifyVarSize(filename, var.header().nNodesPerVolume);
+        storeVar(varIndex, var.data(), true);
+        return var.header();
+    }
+    else
+    {
+        GFileReader<U> var(filename);
+        verifyVarSize(filename, var.data().size());
+        storeVar(varIndex, var.data());
+        return var.header();
+    }
+}
+
+template <class T>
+vector<GHeaderInfo> GDataConverter<T>::readGFVariablesToNodes(
+                                        const vector<GString>& gfFilenames,
+                                        const vector<GString>& varNames)
+{
+    Logger::info(__FILE__, __FUNCTION__, "");
+
+    GSIZET numFiles = gfFilenames.size();
+    GSIZET numThreads = std::min<GSIZET>(numReadThreads(), numFiles);
+    Logger::print(GL_INFO, "Reading " + to_string(numFiles) + " GF " \
+                  "variable files with " + to_string(numThreads) + 
+                  " thread(s)");
+
+    vector<GHeaderInfo> headers(numFiles);
+    std::atomic<GSIZET> next(0);
+    auto start = std::chrono::steady_clock::now();
+
+    // Each worker takes the next unread file until all files are read
+    auto worker = [&]()
+    {
+        for (GSIZET i = next++; i < numFiles; i = next++)
+        {
+            headers[i] = readGFVariableToNodes(gfFilenames[i], varNames[i]);
+        }
+    };
+
+    if (numThreads <= 1)
+    {
+        worker();
+    }
+    else
+    {
+        vector<std::thread> threads;
+        for (GSIZET t = 0; t < numThreads; ++t)
+        {
+            threads.push_back(std::thread(worker));
+        }
+        for (auto& t : threads)
+        {
+            t.join();
+        }
+    }
+
+    // Report the aggregate read bandwidth
+    std::chrono::duration<GDOUBLE> elapsed = 
+                                    std::chrono::steady_clock::now() - start;
+    GDOUBLE nBytes = 0;
+    for (const auto& h : headers)
+    {
+        nBytes += h.nHeaderBytes + numReadNodes() * sizeof(T);
+    }
+    if (Logger::enabled(GL_INFO))
+    {
+        ostringstream msg;
+        msg << "Read " << (nBytes / 1.0e6) << " MB from " << numFiles 
+            << " GF variable files in " << elapsed.count() << " s (" 
+            << (elapsed.count() > 0 ? nBytes / 1.0e6 / elapsed.count() : 0) 
+            << " MB/s)";
+        Logger::print(GL_INFO, msg.str());
+    }
+
+    return headers;
+}
+
+template <class T>
+void GDataConverter<T>::verifyVarSize(const GString& filename, GSIZET size)
+{
+    if (size != _nodes.size())
     {
         string msg = "The size of " + filename + " data (" + \
-                     to_string(var.data().size()) + ") is different than " \
+                     to_string(size) + ") is different than " \
                      "the size of nodes (" + to_string(_nodes.size()) + ")";
         Logger::error(__FILE__, __FUNCTION__, msg);
         exit(EXIT_FAILURE);
     }
+}
+
+template <class T>
+vector<GString> GDataConverter<T>::fieldRootVarNames() const
+{
+    pt::ptree varsArr = PTUtil::getArray(_ptRoot, "field_variable_root_names");
+    return PTUtil::getValues<GString>(varsArr);
+}
+
+template <class T>
+vector<GString> GDataConverter<T>::addTimestep(const GString& timestep)
+{
+    vector<GString> names;
+    for (auto rootVarName : fieldRootVarNames())
+    {
+        GString name = rootVarName + "." + timestep;
+        if (_varIndices.find(name) == _varIndices.end())
+        {
+            _varIndices[name] = _nodes.addVar();
+            _allVarNames.push_back(name);
+            _fieldVarNames.push_back(name);
+        }
+        names.push_back(name);
+    }
+    return names;
+}
+
+template <class T>
+GBOOL GDataConverter<T>::isVariableFileComplete(
+                                            const GString& gfFilename) const
+{
+    struct stat st;
+    if (stat((_inputDir + "/" + gfFilename).c_str(), &st) != 0)
+    {
+        return false;
+    }
+    return _header.valueBytes(st.st_size) != 0;
+}
+
+template <class T>
+void GDataConverter<T>::releaseNodeVariable(const GString& varName)
+{
+    _nodes.releaseVar(toVarIndex(varName));
+}
+
+template <class T>
+template <typename S>
+void GDataConverter<T>::storeVar(GUINT varIndex, const S& data, 
+                                 GBOOL runsOnly)
+{
+    // Copy the data as is if the nodes are sorted after reading, otherwise 
+    // scatter each value straight into its sorted position
+    vector<T>& v = _nodes.allocVar(varIndex);
+    if (_reorder.empty())
+    {
+        for (GSIZET i = 0; i < data.size(); ++i)
+        {
+            v[i] = data[i];
+        }
+    }
+    else if (!_readRuns.empty())
+    {
+        // Only the nodes of the subset's element runs are stored
+        GSIZET k = 0;
+        for (const auto& r : _readRuns)
+        {
+            GSIZET end = (r.first + r.count) * _header.nNodesPerElem;
+            for (GSIZET i = r.first * _header.nNodesPerElem; i < end; ++i, ++k)
+            {
+                v[_reorder[i]] = data[runsOnly ? k : i];
+            }
+        }
+    }
+    else
+    {
+        for (GSIZET i = 0; i < data.size(); ++i)
+        {
+            v[_reorder[i]] = data[i];
+        }
+    }
+}
+
+template <class T>
+void GDataConverter<T>::computeReorderPermutation(const GHeaderInfo& header)
+{
+    Logger::info(__FILE__, __FUNCTION__, "Computing node reorder permutation " \
+                 "from the grid header");
+
+    GUINT nX = header.polyOrder[0] + 1; // num nodes in x ref dir
+    GUINT nY = header.polyOrder[1] + 1; // num nodes in y ref dir
+    GUINT nZ = 1; // 1 = default num nodes in z ref dir for a 2D dataset
+    if (header.polyOrder.size() == 3) // 3D dataset
+    {
+        nZ = header.polyOrder[2] + 1; // num nodes in z ref dir
+    }
+    GUINT nXY = nX * nY; // num nodes per element in x,y ref dir
 
-    // Store variable data into nodes
-    GSIZET numNodes = (var.header()).nNodesPerVolume;
-    for (auto i = 0u; i < numNodes; ++i)
+    // Element layers are sorted bottom to top by their IDs. Get the rank of 
+    // each unique element layer ID.
+    vector<GSIZET> layerIDs(header.nElems);
+    for (GSIZET e = 0; e < header.nElems; ++e)
+    {
+        layerIDs[e] = GET_LOWORD(header.elemIDs[e]);
+    }
+    vector<GSIZET> uniqueIDs(layerIDs);
+    sort(uniqueIDs.begin(), uniqueIDs.end());
+    uniqueIDs.erase(unique(uniqueIDs.begin(), uniqueIDs.end()), 
+                    uniqueIDs.end());
+
+    // Each element keeps its GeoFLOW file order within its element layer
+    vector<GSIZET> nElemsInLayer(uniqueIDs.size(), 0);
+    vector<GUINT>& keys = _nodes.sortKeys();
+    _reorder.resize(header.nNodesPerVolume);
+
+    // For each GeoFLOW element...
+    for (GSIZET e = 0; e < header.nElems; ++e)
     {
-        _nodes[i].var(toVarIndex(varName), var.data()[i]);
-    } 
+        GSIZET i = lower_bound(uniqueIDs.begin(), uniqueIDs.end(), 
+                               layerIDs[e]) - uniqueIDs.begin();
+        GSIZET j = nElemsInLayer[i]++;
+        if (j >= header.nElemPerElemLayer)
+        {
+            std::string msg = "Element layer (" + to_string(layerIDs[e]) + \
+                              ") has more than " + \
+                              to_string(header.nElemPerElemLayer) + \
+                              " elements.";
+            Logger::error(__FILE__, __FUNCTION__, msg);
+            exit(EXIT_FAILURE);
+        }
 
-    return var.header();  
+        // For each 2D layer (x,y ref dir) in the element...
+        GSIZET src = e * header.nNodesPerElem;
+        for (GSIZET k = 0; k < nZ; ++k)
+        {
+            // The 2D element's position in the sorted volume
+            GSIZET key = (i * nZ + k) * header.nElemPerElemLayer + j;
+
+            // For each node in the 2D element (x,y ref dir)...
+            for (GSIZET h = 0; h < nXY; ++h, ++src)
+            {
+                _reorder[src] = key * nXY + h;
+                keys[key * nXY + h] = key;
+            }
+        }
+    }
 }
 
 template <class T>
 void GDataConverter<T>::sortNodesByElemID()
 {
-    Logger::info(__FILE__, __FUNCTION__, "");
-    cout << "Sorting nodes by element ID" << endl;
+    Logger::info(__FILE__, __FUNCTION__, "Sorting nodes by element ID");
 
     // Use stable sort to make sure the same order of objects is retained for 
     // two objects with equal keys (since the original order of nodes within 
-    // a GF element must be retained).
-    stable_sort(_nodes.begin(), _nodes.end());
+    // a GF element must be retained). Only the node positions are sorted; 
+    // every node array is then reordered in one pass.
+    const vector<GSIZET>& ids = _nodes.elemLayerIDs();
+    vector<GSIZET> order(_nodes.size());
+    iota(order.begin(), order.end(), 0);
+    stable_sort(order.begin(), order.end(), 
+                [&ids](GSIZET a, GSIZET b) { return ids[a] < ids[b]; });
+    _nodes.permute(order);
 }
 
 template <class T>
 void GDataConverter<T>::sortNodesBy2DMeshLayer()
 {
-    Logger::info(__FILE__, __FUNCTION__, "");
-    cout << "Sorting nodes by 2D mesh layer" << endl;
+    Logger::info(__FILE__, __FUNCTION__, "Sorting nodes by 2D mesh layer");
 
     // Sort the nodes by 2D mesh layer. For 3D elements, there are multiple 
     // 2D layers (x,y ref dir) in the radial direction
@@ -452,7 +1326,9 @@ void GDataConverter<T>::sortNodesBy2DMeshLayer()
     GUINT nXY = nX * nY; // num nodes per element in x,y ref dir
     GUINT nXYZ = nX * nY * nZ; // num nodes per element in x,y,z dir
     GUINT nNodesPerElemLayer = _header.nElemPerElemLayer * nXYZ;
-    GUINT start, end, count = 0;
+    GSIZET start, end;
+    GUINT count = 0;
+    vector<GUINT>& keys = _nodes.sortKeys();
 
     // For each GeoFLOW element layer...
     for (auto i = 0u; i < _header.nElemLayers; ++i)
@@ -467,10 +1343,10 @@ void GDataConverter<T>::sortNodesBy2DMeshLayer()
                 end = start + nXY;
 
                 // For each node in the 2D element (x,y ref dir)...
-                for (GUINT h = start; h < end; ++h)
+                for (GSIZET h = start; h < end; ++h)
                 {
                     // Assign a sort key to the node
-                    _nodes[h].sortKey(count);
+                    keys[h] = count;
                 }
 
                 ++count;
@@ -481,15 +1357,369 @@ void GDataConverter<T>::sortNodesBy2DMeshLayer()
     // Use stable sort to make sure the same order of objects is retained for 
     // two objects with equal keys (since the original order of nodes within 
     // a GF element must be retained).
-    stable_sort(_nodes.begin(), _nodes.end(), GNode<T>::sort_key_comp);
+    vector<GSIZET> order(_nodes.size());
+    iota(order.begin(), order.end(), 0);
+    stable_sort(order.begin(), order.end(), 
+                [&keys](GSIZET a, GSIZET b) { return keys[a] < keys[b]; });
+    _nodes.permute(order);
+}
+
+template <class T>
+void GDataConverter<T>::selectSubset(const GString& xVarName, 
+                                     const GString& yVarName,
+                                     const GString& depthVarName)
+{
+    Logger::info(__FILE__, __FUNCTION__, "Selecting the subset of the grid " \
+                 "to convert");
+
+    const pt::ptree& subset = PTUtil::getArray(_ptRoot, "subset");
+
+    // The horizontal ranges are on the lon,lat of a spherical grid (in 
+    // degrees) and on the x,y of a box grid, and the depth range is on the 
+    // radius or z
+    GString xKey = is_spherical() ? "lon_range" : "x_range";
+    GString yKey = is_spherical() ? "lat_range" : "y_range";
+    GString depthKey = is_spherical() ? "radius_range" : "z_range";
+    set<GString> keys = {xKey, yKey, depthKey, "polygon", "element_layers"};
+    for (const auto& k : subset)
+    {
+        if (keys.count(k.first) == 0)
+        {
+            std::string msg = "Unknown subset setting (" + k.first + ") " \
+                              "for a " + (is_spherical() ? "spherical" : 
+                              "box") + " grid in property tree: " + \
+                              _ptFilename;
+            Logger::error(__FILE__, __FUNCTION__, msg);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    GDOUBLE xMin, xMax, yMin, yMax, depthMin, depthMax;
+    GBOOL hasX = getSubsetRange(subset, xKey, xMin, xMax);
+    GBOOL hasY = getSubsetRange(subset, yKey, yMin, yMax);
+    GBOOL hasDepth = getSubsetRange(subset, depthKey, depthMin, depthMax);
+
+    // The polygon's x,y (or lon,lat) vertices
+    vector<GDOUBLE> polygon;
+    auto polygonArr = subset.get_child_optional("polygon");
+    if (polygonArr)
+    {
+        for (const auto& p : *polygonArr)
+        {
+            for (const auto& c : p.second)
+            {
+                polygon.push_back(c.second.get_value<GDOUBLE>());
+            }
+        }
+        if (polygon.size() < 6 || polygon.size() % 2 != 0)
+        {
+            std::string msg = "The subset polygon needs 3 or more [x, y] " \
+                              "vertices in property tree: " + _ptFilename;
+            Logger::error(__FILE__, __FUNCTION__, msg);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // Element layers are sorted bottom to top by their IDs
+    vector<GSIZET> uniqueIDs;
+    for (auto id : _header.elemIDs)
+    {
+        uniqueIDs.push_back(GET_LOWORD(id));
+    }
+    sort(uniqueIDs.begin(), uniqueIDs.end());
+    uniqueIDs.erase(unique(uniqueIDs.begin(), uniqueIDs.end()), 
+                    uniqueIDs.end());
+
+    vector<char> keepElemLayer(uniqueIDs.size(), 1);
+    auto layersArr = subset.get_child_optional("element_layers");
+    if (layersArr)
+    {
+        keepElemLayer.assign(uniqueIDs.size(), 0);
+        for (const auto& a : *layersArr)
+        {
+            GSIZET id = a.second.get_value<GSIZET>();
+            auto it = lower_bound(uniqueIDs.begin(), uniqueIDs.end(), id);
+            if (it == uniqueIDs.end() || *it != id)
+            {
+                std::string msg = "The subset element layer (" + \
+                                  to_string(id) + ") is not in the grid.";
+                Logger::error(__FILE__, __FUNCTION__, msg);
+                exit(EXIT_FAILURE);
+            }
+            keepElemLayer[it - uniqueIDs.begin()] = 1;
+        }
+    }
+
+    GUINT nZ = 1; // 1 = default num nodes in z ref dir for a 2D dataset
+    if (_header.polyOrder.size() == 3) // 3D dataset
+    {
+        nZ = _header.polyOrder[2] + 1; // num nodes in z ref dir
+    }
+    GUINT nXY = _header.nNodesPer2DElem;
+    GSIZET layerSize = _header.nNodesPer2DLayer;
+    const vector<T>& x = _nodes.var(toVarIndex(xVarName));
+    const vector<T>& y = _nodes.var(toVarIndex(yVarName));
+    const vector<T>& depth = _nodes.var(toVarIndex(depthVarName));
+
+    // Select the 2D mesh layers of the selected element layers that have a 
+    // node in the depth range
+    _subsetLayers.clear();
+    for (GSIZET l = 0; l < _header.n2DLayers; ++l)
+    {
+        GBOOL keep = keepElemLayer[l / nZ];
+        if (keep && hasDepth)
+        {
+            const T* d = depth.data() + l * layerSize;
+            keep = std::any_of(d, d + layerSize, [&](T v)
+                               { return v >= depthMin && v <= depthMax; });
+        }
+        if (keep)
+        {
+            _subsetLayers.push_back(l);
+        }
+    }
+
+    // Select the 2D elements with a node inside the horizontal ranges and 
+    // the polygon. Every mesh layer has the same x,y, so the first selected 
+    // layer is tested.
+    auto inRange = [](GDOUBLE v, GDOUBLE lo, GDOUBLE hi)
+    {
+        // A range whose min is above its max wraps around (i.e., across 
+        // the 180 degree meridian)
+        return lo <= hi ? (v >= lo && v <= hi) : (v >= lo || v <= hi);
+    };
+    vector<char> keepElem(_header.nElemPerElemLayer, 0);
+    GSIZET nKeepElems = 0;
+    if (!_subsetLayers.empty())
+    {
+        GSIZET offset = _subsetLayers[0] * layerSize;
+        for (GSIZET j = 0; j < _header.nElemPerElemLayer; ++j)
+        {
+            for (GSIZET h = 0; h < nXY && !keepElem[j]; ++h)
+            {
+                GSIZET i = offset + j * nXY + h;
+                keepElem[j] = (!hasX || inRange(x[i], xMin, xMax)) &&
+                              (!hasY || inRange(y[i], yMin, yMax)) &&
+                              (polygon.empty() || 
+                               insidePolygon(polygon, x[i], y[i]));
+            }
+            nKeepElems += keepElem[j];
+        }
+    }
+
+    if (nKeepElems == 0)
+    {
+        std::string msg = "The subset in property tree (" + _ptFilename + \
+                          ") selects no part of the grid.";
+        Logger::error(__FILE__, __FUNCTION__, msg);
+        exit(EXIT_FAILURE);
+    }
+
+    _outElems.clear();
+    if (nKeepElems < _header.nElemPerElemLayer)
+    {
+        for (GSIZET j = 0; j < _header.nElemPerElemLayer; ++j)
+        {
+            if (keepElem[j])
+            {
+                _outElems.push_back(j);
+            }
+        }
+    }
+    _outLayers = _subsetLayers;
+    _dupLayers.clear();
+
+    // Find the runs of GeoFLOW elements that hold a selected 2D element in 
+    // a selected layer. When every 2D element is kept, these are the 
+    // elements of the element layers that have a selected mesh layer.
+    _readRuns.clear();
+    _readLayerIDs.clear();
+    GSIZET nReadElems = 0;
+    if (_outElems.empty())
+    {
+        for (auto l : _subsetLayers)
+        {
+            _readLayerIDs.insert(uniqueIDs[l / nZ]);
+        }
+        _readRuns = GFileReader<T>::elementLayerRuns(_header, _readLayerIDs);
+        for (const auto& r : _readRuns)
+        {
+            nReadElems += r.count;
+        }
+    }
+    else
+    {
+        // The first node of each element is the bottom node of its 2D 
+        // element, in the element's first mesh layer
+        vector<char> keepLayer(_header.n2DLayers, 0);
+        for (auto l : _subsetLayers)
+        {
+            keepLayer[l] = 1;
+        }
+        for (GSIZET e = 0; e < _header.nElems; ++e)
+        {
+            GSIZET pos = _reorder[e * _header.nNodesPerElem];
+            GSIZET layer = pos / layerSize;
+            GSIZET j = (pos % layerSize) / nXY;
+            GBOOL keep = keepElem[j] && 
+                         std::any_of(keepLayer.begin() + layer, 
+                                     keepLayer.begin() + layer + nZ, 
+                                     [](char k) { return k != 0; });
+            if (!keep)
+            {
+                continue;
+            }
+            if (!_readRuns.empty() && 
+                _readRuns.back().first + _readRuns.back().count == e)
+            {
+                ++_readRuns.back().count;
+            }
+            else
+            {
+                _readRuns.push_back({e, 1});
+            }
+            ++nReadElems;
+        }
+    }
+    if (nReadElems == _header.nElems)
+    {
+        _readRuns.clear();
+        _readLayerIDs.clear();
+    }
+
+    Logger::print(GL_INFO, "The subset selects " + to_string(nKeepElems) + 
+                  " of " + to_string(_header.nElemPerElemLayer) + " 2D " \
+                  "elements in " + to_string(_subsetLayers.size()) + " of " + 
+                  to_string(_header.n2DLayers) + " 2D mesh layers; reading " + 
+                  to_string(nReadElems) + " of " + 
+                  to_string(_header.nElems) + " elements in " + 
+                  to_string(_readRuns.size()) + " runs");
+}
+
+template <class T>
+GBOOL GDataConverter<T>::getSubsetRange(const pt::ptree& subset, 
+                                        const GString& key,
+                                        GDOUBLE& minValue, 
+                                        GDOUBLE& maxValue) const
+{
+    auto arr = subset.get_child_optional(key);
+    if (!arr)
+    {
+        return false;
+    }
+
+    vector<GDOUBLE> values;
+    for (const auto& a : *arr)
+    {
+        values.push_back(a.second.get_value<GDOUBLE>());
+    }
+    if (values.size() != 2)
+    {
+        std::string msg = "The subset range (" + key + ") needs a [min, " \
+                          "max] pair in property tree: " + _ptFilename;
+        Logger::error(__FILE__, __FUNCTION__, msg);
+        exit(EXIT_FAILURE);
+    }
+    minValue = values[0];
+    maxValue = values[1];
+    return true;
+}
+
+template <class T>
+GBOOL GDataConverter<T>::insidePolygon(const vector<GDOUBLE>& polygon,
+                                       GDOUBLE x, GDOUBLE y)
+{
+    // Count the polygon edges a ray from the point (in the +x direction) 
+    // crosses; the point is inside if the count is odd
+    GBOOL inside = false;
+    GSIZET n = polygon.size() / 2;
+    for (GSIZET i = 0, k = n - 1; i < n; k = i++)
+    {
+        GDOUBLE xi = polygon[2 * i], yi = polygon[2 * i + 1];
+        GDOUBLE xk = polygon[2 * k], yk = polygon[2 * k + 1];
+        if ((yi > y) != (yk > y) && 
+            x < (xk - xi) * (y - yi) / (yk - yi) + xi)
+        {
+            inside = !inside;
+        }
+    }
+    return inside;
+}
+
+template <class T>
+void GDataConverter<T>::findDuplicate2DMeshLayers(const GString& depthVarName)
+{
+    Logger::info(__FILE__, __FUNCTION__, "Finding duplicate 2D mesh layers " \
+                 "at element layer boundaries");
+
+    GUINT nZ = 1; // 1 = default num nodes in z ref dir for a 2D dataset
+    if (_header.polyOrder.size() == 3) // 3D dataset
+    {
+        nZ = _header.polyOrder[2] + 1; // num nodes in z ref dir
+    }
+
+    // The layers to write from (all of them unless a subset is selected)
+    vector<GSIZET> layers = _subsetLayers;
+    if (layers.empty())
+    {
+        layers.resize(_header.n2DLayers);
+        iota(layers.begin(), layers.end(), 0);
+    }
+
+    _outLayers.clear();
+    _dupLayers.clear();
+    const vector<T>& depth = _nodes.var(toVarIndex(depthVarName));
+
+    // For each 2D mesh layer (bottom to top)...
+    for (GSIZET n = 0; n < layers.size(); ++n)
+    {
+        // The bottom layer of each element layer (except the first) may 
+        // duplicate the top layer of the element layer below it, if that 
+        // layer is written too
+        GSIZET l = layers[n];
+        if (nZ > 1 && l % nZ == 0 && n > 0 && layers[n - 1] == l - 1 && 
+            layersMatch(depth, l - 1, l))
+        {
+            _dupLayers.push_back(l);
+        }
+        else
+        {
+            _outLayers.push_back(l);
+        }
+    }
+
+    Logger::print(GL_INFO, "Found " + to_string(_dupLayers.size()) + 
+                  " duplicate 2D mesh layers; writing " + 
+                  to_string(_outLayers.size()) + " of " + 
+                  to_string(layers.size()) + " layers");
+}
+
+template <class T>
+GBOOL GDataConverter<T>::layersMatch(const vector<T>& v, GSIZET a, 
+                                     GSIZET b) const
+{
+    GDOUBLE tol = duplicateLayerTolerance();
+    GSIZET n = _header.nNodesPer2DLayer;
+    const T* va = v.data() + a * n;
+    const T* vb = v.data() + b * n;
+    for (GSIZET i = 0; i < n; ++i)
+    {
+        GDOUBLE diff = std::abs(GDOUBLE(va[i]) - GDOUBLE(vb[i]));
+        GDOUBLE scale = std::max(std::abs(GDOUBLE(va[i])), 
+                                 std::abs(GDOUBLE(vb[i])));
+        if (diff > tol * scale)
+        {
+            return false;
+        }
+    }
+    return true;
 }
 
 template <class T>
 void GDataConverter<T>::faceToNodes()
 {
-    Logger::info(__FILE__, __FUNCTION__, "");
-    cout << "Mapping faces to nodes (i.e., creating a list of GFace objects)" \
-         << endl;
+    Logger::info(__FILE__, __FUNCTION__, "Mapping faces to nodes (i.e., " \
+                 "creating the face connectivity buffer)");
 
     // Create a mapping of face to nodes for the first 2D mesh layer. This 
     // mapping is the same for each layer. The assumption here is the nodes 
@@ -498,71 +1728,89 @@ void GDataConverter<T>::faceToNodes()
     // together, and the faces for one 2D element are listed left to right, 
     // top to bottom
 
+    // At a level of detail, the faces join the nodes written in each 
+    // element
     GUINT nX = _header.polyOrder[0] + 1; // num nodes in x ref dir
     GUINT nY = _header.polyOrder[1] + 1; // num nodes in y ref dir
+    if (!_lodNodes.empty())
+    {
+        nX = _lodNX;
+        nY = _lodNY;
+    }
     GUINT nXY = nX * nY; // num nodes per element in x,y ref dir
+    GSIZET nFacesPerElem = (nX - 1) * (nY - 1);
 
-    _faces.clear();
-    _faces.shrink_to_fit();
+    // The 2D elements written are numbered in the order they are written 
+    // (all of them, or the subset's)
+    GSIZET nElems = num2DMeshNodes() / nXY;
 
-    // For each 2D element in the first layer...
-    for (auto i = 0u; i < _header.nNodesPer2DLayer; i += nXY)
+    // The node indices are written as 32-bit values
+    if (num2DMeshNodes() > std::numeric_limits<GUINT>::max())
     {
-        // Get all the faces in the 2D element. Nodes for a face must be 
-        // specified in counter-clockwise direction. Here we use the top-left 
-        // node as the starting point for each face
+        std::string msg = "The num nodes per 2D mesh layer (" + \
+                          to_string(num2DMeshNodes()) + ") does " \
+                          "not fit the 32-bit face node indices.";
+        Logger::error(__FILE__, __FUNCTION__, msg);
+        exit(EXIT_FAILURE);
+    }
 
-        // For each row of faces in the element...
-        for (auto x = 0u; x < nX - 1; ++x)
+    // Each 2D element's faces take a fixed range of the buffer, so the 
+    // elements are filled in parallel
+    _faceNodes.assign(nElems * nFacesPerElem * G_FACE_NODES, 0);
+    GUINT* faceNodes = _faceNodes.data();
+    ThreadUtil::parallelFor(nElems, 1024, 
+                            [=](GSIZET begin, GSIZET end)
+    {
+        // For each 2D element in the first layer...
+        for (GSIZET e = begin; e < end; ++e)
         {
-            // For each column of faces in the element...
-            for (auto y = 0u; y < nY - 1; ++y)
+            // Get all the faces in the 2D element. Nodes for a face must be 
+            // specified in counter-clockwise direction. Here we use the 
+            // top-left node as the starting point for each face
+            GUINT i = e * nXY;
+            GUINT* f = faceNodes + e * nFacesPerElem * G_FACE_NODES;
+
+            // For each row of faces in the element...
+            for (GUINT x = 0; x < nX - 1; ++x)
             {
-                // Get the indices of the face
-                vector<GSIZET> indices;
-                indices.push_back(i + (x * nY) + y);             // bottom left
-                indices.push_back(i + (x * nY) + (y + 1));       // bottom right
-                indices.push_back(i + ((x + 1) * nY) + (y + 1)); // top right
-                indices.push_back(i + ((x + 1) * nY) + y);       // top left
-
-                // Add the face to the list
-                _faces.push_back(GFace(indices));
+                // For each column of faces in the element...
+                for (GUINT y = 0; y < nY - 1; ++y)
+                {
+                    *f++ = i + (x * nY) + y;             // bottom left
+                    *f++ = i + (x * nY) + (y + 1);       // bottom right
+                    *f++ = i + ((x + 1) * nY) + (y + 1); // top right
+                    *f++ = i + ((x + 1) * nY) + y;       // top left
+                }
             }
-        } 
-    }
+        }
+    });
 }
 
 template <class T>
 void GDataConverter<T>::setDimensions(const map<GString, GSIZET>& dims)
 {
-    Logger::info(__FILE__, __FUNCTION__, "");
-    cout << "Setting mesh dimensions in the property tree from GeoFLOW data" 
-         << endl;
-
-    pt::ptree& dimArr = PTUtil::getArrayRef(_ptRoot, "dimensions");
+    Logger::info(__FILE__, __FUNCTION__, "Setting mesh dimensions in the " \
+                 "schema from GeoFLOW data");
 
-    // For each dimension in the dimensions array...
-    for (pt::ptree::iterator it = dimArr.begin(); it != dimArr.end(); ++it)
+    // For each dimension in the schema...
+    for (GUINT h = 0; h < _schema.numDimensions(); ++h)
     {
-        // Get the values of the specified keys
-        GString dimName = PTUtil::getValue<GString>(it->second, "name");
-        GSIZET dimValue = PTUtil::getValue<GSIZET>(it->second, "value");
+        const GSchemaDimension& dim = _schema.dimension(h);
 
         // If the value of the dimension in the property tree is 0, the value 
         // needs to be set using the value in the input dimensions map
-        if (dimValue == 0)
+        if (dim.value == 0 || _runtimeDims.count(h) != 0)
         {
             // Look for the dimension name in the input dimensions map
             map<GString, GSIZET>::const_iterator itMap;
-            itMap = dims.find(dimName);
+            itMap = dims.find(dim.name);
             if (itMap != dims.end())
             {
-               // Write the value found in the map to the dimension value in 
-               // the property tree
-               PTUtil::putValue<GSIZET>(it->second, "value", dims.at(dimName));
+               _schema.setDimensionValue(h, itMap->second);
+               _runtimeDims.insert(h);
             }
             else {
-                std::string msg = "Could not find dimension (" + dimName + \
+                std::string msg = "Could not find dimension (" + dim.name + \
                                   ") in the property tree.";
                 Logger::error(__FILE__, __FUNCTION__, msg);
                 exit(EXIT_FAILURE);
@@ -584,7 +1832,7 @@ void GDataConverter<T>::initNC(const GString& ncFilename,
     GString filename = _outputDir + "/" + ncFilename;
 
     // Initialize a GToNetCDF object
-    _nc = new GToNetCDF(_ptRoot, filename, mode);
+    _nc = new GToNetCDF(_schema, filename, mode);
 }
 
 template <class T>
@@ -624,9 +1872,86 @@ void GDataConverter<T>::writeNCNodeVariable(const GString& rootVarName,
     Logger::info(__FILE__, __FUNCTION__, "");
 
     // Write the contents of a node variable to the NetCDF file
+    const vector<T>& v = _nodes.var(toVarIndex(fullVarName));
     _nc->writeVariableDefinition(rootVarName);
     _nc->writeVariableAttributes(rootVarName);
-    _nc->writeVariableData<T>(rootVarName, toVarIndex(fullVarName), _nodes);
+
+    // Verify the duplicate layers being dropped hold the same data as the 
+    // layer below them before writing only the non-duplicate layers
+    for (auto l : _dupLayers)
+    {
+        if (!layersMatch(v, l - 1, l))
+        {
+            std::string msg = "2D mesh layer " + to_string(l) + " of " \
+                              "variable (" + fullVarName + ") differs from " \
+                              "layer " + to_string(l - 1) + " and cannot " \
+                              "be removed as a duplicate. Set " \
+                              "remove_duplicate_layers to false.";
+            Logger::error(__FILE__, __FUNCTION__, msg);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // Produce the values of a group of output mesh layers. Consecutive 
+    // layers are handed to the writer in place; layers that are not 
+    // consecutive in the node array (i.e., around a dropped duplicate) are 
+    // gathered into a buffer the size of the group, and so are the 
+    // selected 2D elements of each layer of a subset and the selected nodes 
+    // of each element at a level of detail.
+    const vector<GSIZET>& layers = _lodLayers.empty() ? _outLayers : 
+                                                        _lodLayers;
+    GSIZET layerSize = _header.nNodesPer2DLayer;
+    GSIZET outLayerSize = num2DMeshNodes();
+    GSIZET nXY = _header.nNodesPer2DElem;
+    GSIZET nOutElems = _outElems.empty() ? _header.nElemPerElemLayer : 
+                                           _outElems.size();
+    GBOOL allNodes = _outElems.empty() && _lodNodes.empty();
+    vector<T> buf;
+    auto produce = [&](GSIZET first, GSIZET n) -> const T*
+    {
+        if (allNodes)
+        {
+            if (layers.empty())
+            {
+                return v.data() + first * layerSize;
+            }
+            if (layers[first + n - 1] - layers[first] == n - 1)
+            {
+                return v.data() + layers[first] * layerSize;
+            }
+        }
+
+        buf.resize(n * outLayerSize);
+        T* dst = buf.data();
+        for (GSIZET j = 0; j < n; ++j)
+        {
+            GSIZET l = layers.empty() ? first + j : layers[first + j];
+            const T* src = v.data() + l * layerSize;
+            if (allNodes)
+            {
+                dst = std::copy(src, src + layerSize, dst);
+                continue;
+            }
+            for (GSIZET k = 0; k < nOutElems; ++k)
+            {
+                const T* elem = src + (_outElems.empty() ? k : _outElems[k]) * 
+                                      nXY;
+                if (_lodNodes.empty())
+                {
+                    dst = std::copy(elem, elem + nXY, dst);
+                    continue;
+                }
+                for (auto h : _lodNodes)
+                {
+                    *dst++ = elem[h];
+                }
+            }
+        }
+        return buf.data();
+    };
+
+    _nc->writeVariableLayers<T>(rootVarName, num2DMeshLayers(), outLayerSize,
+                                numLayersPerWrite(), produce);
 }
 
 template <class T>
@@ -0,0 +1,392 @@
+//==============================================================================
+// Date      : 10/16/26 (agent)
+// Copyright : Copyright 2021. Regents of the University of Colorado.
+//             All rights reserved.
+//==============================================================================
+
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <map>
+#include <sys/stat.h>
+
+#include "gdataset_validator.h"
+#include "gdir_watcher.h"
+#include "gfile_reader.h"
+#include "thread_util.h"
+#include "logger.h"
+
+// Extension of the GeoFLOW field variable files
+static const char G_FILE_EXT[] = ".out";
+
+GDatasetValidator::GDatasetValidator(const GString& ptFilename)
+{
+    Logger::info(__FILE__, __FUNCTION__, "");
+
+    _ptFilename = ptFilename;
+    pt::ptree root;
+    PTUtil::readJSONFile(_ptFilename, root);
+    Logger::setLevel(PTUtil::getValue<GString>(root, "log_level", 
+                                               "warning"));
+    _inputDir = PTUtil::getValue<GString>(root, "input_dir");
+
+    // The x grid file comes first, as the reference for the other files
+    const char* gridKeys[] = {"grid_filenames.x", "grid_filenames.y",
+                              "grid_filenames.z"};
+    for (auto key : gridKeys)
+    {
+        GValidationFile f;
+        f.name = PTUtil::getValue<GString>(root, key);
+        _files.push_back(f);
+    }
+
+    // Field variable files are named rootName.timestep.out (rootName.out
+    // without timesteps)
+    pt::ptree varsArr = PTUtil::getArray(root, "field_variable_root_names");
+    vector<GString> rootVarNames = PTUtil::getValues<GString>(varsArr);
+    GUINT numTimesteps = PTUtil::getValue<GUINT>(root, "num_timesteps");
+    if (PTUtil::getValue<GBOOL>(root, "follow", false) && 
+        !rootVarNames.empty())
+    {
+        // When following, only the timesteps written so far are checked
+        GString prefix = rootVarNames[0] + ".";
+        GString ext = G_FILE_EXT;
+        vector<GString> timesteps;
+        for (auto name : GDirWatcher::listFiles(_inputDir))
+        {
+            if (name.size() > prefix.size() + ext.size() &&
+                name.compare(0, prefix.size(), prefix) == 0 &&
+                name.compare(name.size() - ext.size(), ext.size(), ext) == 0)
+            {
+                GString timestep = name.substr(prefix.size(),
+                                   name.size() - prefix.size() - ext.size());
+                if (timestep.find_first_not_of("0123456789") == 
+                    string::npos && 
+                    (numTimesteps == 0 || stoull(timestep) < numTimesteps))
+                {
+                    timesteps.push_back(timestep);
+                }
+            }
+        }
+        std::sort(timesteps.begin(), timesteps.end());
+        addFieldFiles(rootVarNames, timesteps);
+    }
+    else if (numTimesteps == 0)
+    {
+        addFieldFiles(rootVarNames, vector<GString>());
+    }
+    else
+    {
+        vector<GString> timesteps;
+        for (auto i = 0u; i < numTimesteps; ++i)
+        {
+            stringstream ss;
+            ss << std::setfill('0') << std::setw(6) << i;
+            timesteps.push_back(ss.str());
+        }
+        addFieldFiles(rootVarNames, timesteps);
+    }
+
+    Logger::print(GL_INFO, "Validating " + to_string(_files.size()) +
+                           " files in directory: " + _inputDir);
+}
+
+void GDatasetValidator::addFieldFiles(const vector<GString>& rootVarNames,
+                                      const vector<GString>& timesteps)
+{
+    if (timesteps.empty())
+    {
+        for (auto rootVarName : rootVarNames)
+        {
+            GValidationFile f;
+            f.name = rootVarName + G_FILE_EXT;
+            _files.push_back(f);
+        }
+        return;
+    }
+
+    for (auto timestep : timesteps)
+    {
+        for (auto rootVarName : rootVarNames)
+        {
+            GValidationFile f;
+            f.name = rootVarName + "." + timestep + G_FILE_EXT;
+            f.timestep = timestep;
+            _files.push_back(f);
+        }
+    }
+}
+
+GSIZET GDatasetValidator::validate()
+{
+    Logger::info(__FILE__, __FUNCTION__, "");
+
+    // Check the x grid file, then the others against its header. Only
+    // headers are read, so the files are checked by one thread per core.
+    checkFile(_files[0], 0);
+    if (_files[0].hasHeader)
+    {
+        checkElementLayers(_files[0]);
+    }
+    const GHeaderInfo* ref = _files[0].hasHeader ? &_files[0].header : 0;
+    ThreadUtil::parallelFor(_files.size() - 1, 1,
+        [&](GSIZET begin, GSIZET end)
+        {
+            for (GSIZET i = begin; i < end; ++i)
+            {
+                checkFile(_files[i + 1], ref);
+
+                // Only the x grid file's element IDs are kept (the 
+                // reference for the other files)
+                _files[i + 1].header.elemIDs.clear();
+                _files[i + 1].header.elemIDs.shrink_to_fit();
+            }
+        });
+    _files[0].header.elemIDs.clear();
+    _files[0].header.elemIDs.shrink_to_fit();
+    checkTimes();
+
+    GSIZET nErrors = 0;
+    for (const auto& f : _files)
+    {
+        for (const auto& p : f.problems)
+        {
+            nErrors += (p.severity == "error");
+        }
+    }
+    Logger::print(GL_INFO, "Found " + to_string(nErrors) + " errors in " +
+                           to_string(_files.size()) + " files");
+    return nErrors;
+}
+
+void GDatasetValidator::checkFile(GValidationFile& f,
+                                  const GHeaderInfo* ref) const
+{
+    GString filename = _inputDir + "/" + f.name;
+    f.hasHeader = false;
+    f.size = 0;
+    f.valueBytes = 0;
+
+    struct stat st;
+    if (stat(filename.c_str(), &st) != 0)
+    {
+        addProblem(f, "error", "exists", "Cannot find file: " + filename);
+        return;
+    }
+    f.size = st.st_size;
+
+    GString msg;
+    if (!GFileReader<GDOUBLE>::readHeader(filename, f.header, msg))
+    {
+        addProblem(f, "error", "header", msg);
+        return;
+    }
+    f.hasHeader = true;
+    const GHeaderInfo& h = f.header;
+
+    // The data must be one float or double value per node
+    f.valueBytes = h.valueBytes(f.size);
+    if (f.valueBytes == 0)
+    {
+        ostringstream oss;
+        oss << "File size is " << f.size << " bytes, expected "
+            << h.nHeaderBytes << " header bytes + " << h.nNodesPerVolume
+            << " nodes * " << sizeof(GFLOAT) << " (or " << sizeof(GDOUBLE)
+            << ") bytes = " << h.nHeaderBytes + h.nNodesPerVolume *
+            sizeof(GFLOAT) << " (or " << h.nHeaderBytes + h.nNodesPerVolume *
+            sizeof(GDOUBLE) << ") bytes";
+        addProblem(f, "error", "size", oss.str());
+    }
+
+    if (ref != 0)
+    {
+        // All files are read with the value type of the x grid file
+        GSIZET refValueBytes = _files[0].valueBytes;
+        if (f.valueBytes != 0 && refValueBytes != 0 &&
+            f.valueBytes != refValueBytes)
+        {
+            addProblem(f, "error", "value_type", "Values are " +
+                       to_string(f.valueBytes) + " bytes each, but the x " \
+                       "grid file's are " + to_string(refValueBytes) +
+                       " bytes each");
+        }
+
+        // The elements must be those of the grid, in the same order
+        vector<GString> diffs;
+        if (h.dim != ref->dim)
+        {
+            diffs.push_back("dim " + to_string(h.dim) + " (grid " +
+                            to_string(ref->dim) + ")");
+        }
+        else if (h.polyOrder != ref->polyOrder)
+        {
+            diffs.push_back("poly orders differ");
+        }
+        if (h.nElems != ref->nElems)
+        {
+            diffs.push_back("num elements " + to_string(h.nElems) +
+                            " (grid " + to_string(ref->nElems) + ")");
+        }
+        else
+        {
+            // Elements are placed by their element layer (the low word of 
+            // the element ID)
+            auto m = std::mismatch(h.elemIDs.begin(), h.elemIDs.end(),
+                                   ref->elemIDs.begin(),
+                                   [](GSIZET a, GSIZET b)
+                                   { return GET_LOWORD(a) == GET_LOWORD(b); });
+            if (m.first != h.elemIDs.end())
+            {
+                diffs.push_back("element layers differ from element " +
+                                to_string(m.first - h.elemIDs.begin()));
+            }
+        }
+        if (!diffs.empty())
+        {
+            GString message = "Elements differ from the x grid file's:";
+            for (GSIZET i = 0; i < diffs.size(); ++i)
+            {
+                message += (i == 0 ? " " : ", ") + diffs[i];
+            }
+            addProblem(f, "error", "grid_consistency", message);
+        }
+
+        if (h.version != ref->version || h.gridType != ref->gridType)
+        {
+            addProblem(f, "warning", "grid_consistency", "Version (" +
+                       to_string(h.version) + ") or grid type (" +
+                       to_string(h.gridType) + ") differs from the x " \
+                       "grid file's (" + to_string(ref->version) + ", " +
+                       to_string(ref->gridType) + ")");
+        }
+    }
+}
+
+void GDatasetValidator::checkElementLayers(GValidationFile& f)
+{
+    // The low word of an element ID is its element layer
+    map<GSIZET, GSIZET> layerSizes;
+    for (auto id : f.header.elemIDs)
+    {
+        ++layerSizes[GET_LOWORD(id)];
+    }
+    for (const auto& l : layerSizes)
+    {
+        if (l.second != f.header.nElemPerElemLayer)
+        {
+            addProblem(f, "error", "element_layers", "Element layer " +
+                       to_string(l.first) + " has " + to_string(l.second) +
+                       " elements, but the grid has " +
+                       to_string(f.header.nElemPerElemLayer) +
+                       " elements per element layer (" +
+                       to_string(f.header.nElems) + " elements in " +
+                       to_string(layerSizes.size()) + " layers)");
+            return;
+        }
+    }
+}
+
+void GDatasetValidator::checkTimes()
+{
+    // The time of a timestep's output is taken from one of its files
+    map<GString, GValidationFile*> first;
+    for (auto& f : _files)
+    {
+        if (f.timestep.empty() || !f.hasHeader)
+        {
+            continue;
+        }
+        auto it = first.find(f.timestep);
+        if (it == first.end())
+        {
+            first[f.timestep] = &f;
+        }
+        else if (f.header.timeCycle != it->second->header.timeCycle ||
+                 f.header.timeStamp != it->second->header.timeStamp)
+        {
+            ostringstream oss;
+            oss << "Time cycle " << f.header.timeCycle << " and time stamp "
+                << f.header.timeStamp << " differ from those of "
+                << it->second->name << " (" << it->second->header.timeCycle
+                << ", " << it->second->header.timeStamp << ")";
+            addProblem(f, "warning", "time", oss.str());
+        }
+    }
+}
+
+void GDatasetValidator::addProblem(GValidationFile& f,
+                                   const GString& severity,
+                                   const GString& check,
+                                   const GString& message)
+{
+    f.problems.push_back({f.name, severity, check, message});
+}
+
+void GDatasetValidator::writeReport(ostream& os, GBOOL withFiles) const
+{
+    GSIZET nErrors = 0;
+    GSIZET nWarnings = 0;
+    for (const auto& f : _files)
+    {
+        for (const auto& p : f.problems)
+        {
+            nErrors += (p.severity == "error");
+            nWarnings += (p.severity == "warning");
+        }
+    }
+
+    os << std::setprecision(17);
+    os << "{" << endl;
+    os << "\"json_file\": " << PTUtil::quote(_ptFilename) << "," << endl;
+    os << "\"input_dir\": " << PTUtil::quote(_inputDir) << "," << endl;
+    os << "\"num_files\": " << _files.size() << "," << endl;
+    os << "\"num_errors\": " << nErrors << "," << endl;
+    os << "\"num_warnings\": " << nWarnings << "," << endl;
+    os << "\"problems\":" << endl << "[";
+    GString sep = "\n";
+    for (const auto& f : _files)
+    {
+        for (const auto& p : f.problems)
+        {
+            os << sep << "    {\"file\": " << PTUtil::quote(p.file) << ", "
+               << "\"severity\": " << PTUtil::quote(p.severity) << ", "
+               << "\"check\": " << PTUtil::quote(p.check) << ", "
+               << "\"message\": " << PTUtil::quote(p.message) << "}";
+            sep = ",\n";
+        }
+    }
+    os << (sep == "\n" ? "]" : "\n]");
+
+    if (withFiles)
+    {
+        os << "," << endl << "\"files\":" << endl << "[";
+        sep = "\n";
+        for (const auto& f : _files)
+        {
+            os << sep << "    {\"name\": " << PTUtil::quote(f.name) << ", "
+               << "\"size\": " << f.size << ", "
+               << "\"value_bytes\": " << f.valueBytes;
+            if (f.hasHeader)
+            {
+                const GHeaderInfo& h = f.header;
+                os << ", \"version\": " << h.version << ", "
+                   << "\"dim\": " << h.dim << ", "
+                   << "\"num_elems\": " << h.nElems << ", "
+                   << "\"poly_order\": [";
+                for (GSIZET i = 0; i < h.polyOrder.size(); ++i)
+                {
+                    os << (i == 0 ? "" : ", ") << h.polyOrder[i];
+                }
+                os << "], \"grid_type\": " << h.gridType << ", "
+                   << "\"num_elem_layers\": " << h.nElemLayers << ", "
+                   << "\"header_bytes\": " << h.nHeaderBytes << ", "
+                   << "\"time_cycle\": " << h.timeCycle << ", "
+                   << "\"time_stamp\": " << h.timeStamp;
+            }
+            os << "}";
+            sep = ",\n";
+        }
+        os << (sep == "\n" ? "]" : "\n]");
+    }
+    os << endl << "}" << endl;
+}
@@ -0,0 +1,95 @@
+//==============================================================================
+// Date      : 10/16/26 (agent)
+// Copyright : Copyright 2021. Regents of the University of Colorado.
+//             All rights reserved.
+//==============================================================================
+
+#include <sstream>
+#include <cstring>
+#include <cerrno>
+#include <dirent.h>
+#include <poll.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+#include "gdir_watcher.h"
+#include "logger.h"
+
+GDirWatcher::GDirWatcher(const GString& dirName, GDOUBLE pollSeconds)
+    : _dirName(dirName), _pollSeconds(pollSeconds), _fd(-1)
+{
+#ifdef __linux__
+    _fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (_fd >= 0 &&
+        inotify_add_watch(_fd, dirName.c_str(),
+                          IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0)
+    {
+        close(_fd);
+        _fd = -1;
+    }
+#endif
+
+    if (usesInotify())
+    {
+        Logger::print(GL_INFO, "Watching directory with inotify: " + dirName);
+    }
+    else
+    {
+        ostringstream oss;
+        oss << "Polling directory every " << pollSeconds << " s: " << dirName;
+        Logger::print(GL_INFO, oss.str());
+    }
+}
+
+GDirWatcher::~GDirWatcher()
+{
+    if (_fd >= 0)
+    {
+        close(_fd);
+    }
+}
+
+void GDirWatcher::wait()
+{
+    int timeoutMs = (int)(_pollSeconds * 1000);
+    if (_fd < 0)
+    {
+        // Sleep for the polling interval (returns early on a signal)
+        poll(0, 0, timeoutMs);
+        return;
+    }
+
+    struct pollfd pfd;
+    pfd.fd = _fd;
+    pfd.events = POLLIN;
+    if (poll(&pfd, 1, timeoutMs) > 0)
+    {
+        // The directory is rescanned by the caller, so the events are only
+        // drained
+        char buf[4096];
+        while (read(_fd, buf, sizeof(buf)) > 0) {}
+    }
+}
+
+vector<GString> GDirWatcher::listFiles(const GString& dirName)
+{
+    vector<GString> filenames;
+    DIR* dir = opendir(dirName.c_str());
+    if (dir == 0)
+    {
+        std::string msg = "Cannot open directory: " + dirName + " (" + \
+                          strerror(errno) + ")";
+        Logger::error(__FILE__, __FUNCTION__, msg);
+        exit(EXIT_FAILURE);
+    }
+
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != 0)
+    {
+        filenames.push_back(entry->d_name);
+    }
+    closedir(dir);
+    return filenames;
+}
@@ -5,7 +5,14 @@
 //==============================================================================
 
 #include <fstream>
-#include <set>
+#include <cstring>
+#include <cerrno>
+#include <climits>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
 
 #include "logger.h"
 
@@ -15,7 +22,7 @@ GFileReader<T>::GFileReader(const GString& filename)
     // Read header
     _header = readHeader(filename);
 
-    // Print header
+    // Print header (debug log level)
     _header.printHeader();
 
     // Read data
@@ -25,99 +32,164 @@ GFileReader<T>::GFileReader(const GString& filename)
     setElementLayerIDs();
 }
 
+template <class T>
+GFileReader<T>::GFileReader(const GString& filename, 
+                            const vector<GElemRun>& runs)
+{
+    // Read header
+    _header = readHeader(filename);
+
+    // Print header (debug log level)
+    _header.printHeader();
+
+    // Read the data of the element runs
+    readElementRuns(filename, runs);
+}
+
+template <class T>
+GFileReader<T>::GFileReader(const GString& filename, 
+                            const set<GSIZET>& layerIDs)
+{
+    // Read header
+    _header = readHeader(filename);
+
+    // Print header (debug log level)
+    _header.printHeader();
+
+    // Read the data of the elements in the element layers
+    vector<GElemRun> runs = elementLayerRuns(_header, layerIDs);
+    readElementRuns(filename, runs);
+
+    // Set GeoFLOW element layer ID for each data value
+    setElementLayerIDs(runs);
+}
+
+template <class T>
+vector<GElemRun> GFileReader<T>::elementLayerRuns(const GHeaderInfo& header,
+                                                  const set<GSIZET>& layerIDs)
+{
+    vector<GElemRun> runs;
+    for (GSIZET e = 0; e < header.nElems; ++e)
+    {
+        if (layerIDs.count(GET_LOWORD(header.elemIDs[e])) == 0)
+        {
+            continue;
+        }
+        if (!runs.empty() && runs.back().first + runs.back().count == e)
+        {
+            ++runs.back().count;
+        }
+        else
+        {
+            runs.push_back({e, 1});
+        }
+    }
+    return runs;
+}
+
 template <class T>
 GHeaderInfo GFileReader<T>::readHeader(const GString& filename)
 {
-    cout << "Reading GeoFLOW header from file: " << filename << endl;
+    Logger::print(GL_INFO, "Reading GeoFLOW header from file: " + filename);
 
-    // Open file
-    ifstream ifs(filename, ios::in | ios::binary);
-    if (!ifs)
+    GHeaderInfo h;
+    GString msg;
+    if (!readHeader(filename, h, msg))
     {
-        string msg = "Cannot open file: " + filename;
         Logger::error(__FILE__, __FUNCTION__, msg);
         exit(EXIT_FAILURE);
     }
+    return h;
+}
+
+template <class T>
+GBOOL GFileReader<T>::readHeader(const GString& filename, GHeaderInfo& h,
+                                 GString& msg)
+{
+    // Open file and get its size
+    ifstream ifs(filename, ios::in | ios::binary | ios::ate);
+    if (!ifs)
+    {
+        msg = "Cannot open file: " + filename;
+        return false;
+    }
+    GSIZET fileSize = ifs.tellg();
+    ifs.seekg(0);
 
     // Read header info
-    GHeaderInfo h;
     ifs.read((char*)&h.version, sizeof(h.version));
     ifs.read((char*)&h.dim, sizeof(h.dim));
     ifs.read((char*)&h.nElems, sizeof(h.nElems));
-    h.polyOrder.resize(h.dim); // each ref dir has its own poly order
-    for (auto& p : h.polyOrder)
+
+    // Verify data. The dimension and element count are checked before they 
+    // size the arrays read below, so a file that is not a GeoFLOW file (or 
+    // is cut short) is reported instead of read past its end
+    if (ifs && h.dim < 2)
     {
-        ifs.read((char*)&p, sizeof(h.polyOrder[0]));
+        msg = "Found only (" + to_string(h.dim) + ") " + \
+              "polynomial orders in file: " + filename + ". Need " + \
+              "a minimum of 2 (for each x & y reference direction).";
+        return false;
     }
-
-    // Verify data
-    if (h.polyOrder.size() < 2)
+    if (!ifs || h.dim > 3 || h.nElems == 0)
     {
-        string msg = "Found only (" + to_string(h.polyOrder.size()) + ") " + \
-                     "polynomial orders in file: " + filename + ". Need " + \
-                     "a minimum of 2 (for each x & y reference direction).";
-        Logger::error(__FILE__, __FUNCTION__, msg);
-        exit(EXIT_FAILURE);       
+        msg = "Cannot read a GeoFLOW header of 2D or 3D elements from " \
+              "file: " + filename + " (file size " + to_string(fileSize) + \
+              " bytes)";
+        return false;
     }
-    
+    if (h.nElems > fileSize / sizeof(h.elemIDs[0]))
+    {
+        msg = "The header of file: " + filename + " is cut short (file " \
+              "size " + to_string(fileSize) + " bytes)";
+        return false;
+    }
+
+    h.polyOrder.resize(h.dim); // each ref dir has its own poly order
+    ifs.read((char*)h.polyOrder.data(), h.dim * sizeof(h.polyOrder[0]));
     ifs.read((char*)&h.gridType, sizeof(h.gridType));
     ifs.read((char*)&h.timeCycle, sizeof(h.timeCycle));
     ifs.read((char*)&h.timeStamp, sizeof(h.timeStamp));
     ifs.read((char*)&h.hasMultVars, sizeof(h.hasMultVars));
 
     h.elemIDs.resize(h.nElems);
-    for (auto& e : h.elemIDs)
+    ifs.read((char*)h.elemIDs.data(), h.nElems * sizeof(h.elemIDs[0]));
+    if (!ifs)
     {
-        ifs.read((char*)&e, sizeof(h.elemIDs[0]));
+        msg = "The header of file: " + filename + " is cut short (file " \
+              "size " + to_string(fileSize) + " bytes)";
+        return false;
     }
 
     // Get total byte size of header
     h.nHeaderBytes = ifs.tellg(); // curr pos in file stream
     
-    // Get num nodes per GeoFLOW element (2D or 3D). Num nodes in one 
-    // reference direction of one element = (poly order + 1)
-    h.nNodesPerElem = 1;
-    for (const auto& p : h.polyOrder)
-    {
-        h.nNodesPerElem *= (p+1);
-    }
+    // Get the auxiliary data derived from the header
+    h.deriveInfo();
+
+    ifs.close();
 
-    // Get num nodes in volume
-    h.nNodesPerVolume = h.nElems * h.nNodesPerElem;
+    return true;
+}
 
-    // Get num nodes per 2D element (x,y ref dir). Num nodes in one reference 
-    // direction of one element = (poly order + 1)
-    h.nNodesPer2DElem = 1;
-    for (auto i = 0u; i < 2; ++i)
+template <class T>
+GSIZET GFileReader<T>::readValueBytes(const GString& filename)
+{
+    GHeaderInfo h = readHeader(filename);
+    struct stat st;
+    if (stat(filename.c_str(), &st) != 0)
     {
-        h.nNodesPer2DElem *= (h.polyOrder[i] + 1);
+        string msg = "Cannot open file: " + filename;
+        Logger::error(__FILE__, __FUNCTION__, msg);
+        exit(EXIT_FAILURE);
     }
-
-    // Get num GeoFLOW element layers
-    set<GSIZET> uniqueIDs(h.elemIDs.begin(), h.elemIDs.end());
-    h.nElemLayers = uniqueIDs.size();
-
-    // Get num GeoFLOW elments per GeoFLOW element layer
-    h.nElemPerElemLayer = h.nElems / h.nElemLayers;
-
-    // Get num nodes per 2D layer (x,y ref dir)
-    h.nNodesPer2DLayer = h.nElemPerElemLayer * h.nNodesPer2DElem;
-
-    // Get num faces (includes sub faces) per 2D layer (x,y ref dir)
-    h.nFacesPer2DLayer = h.nElemPerElemLayer * (h.polyOrder[0] * h.polyOrder[1]);
-
-    // Get num 2D layers in the entire volume
-    h.n2DLayers = h.nNodesPerVolume / h.nNodesPer2DLayer;
-
-    ifs.close();
-
-    return h;
+    return h.valueBytes(st.st_size);
 }
 
 template <class T>
 void GFileReader<T>::readData(const GString& filename)
 {
-    cout << "Reading GeoFLOW data from file: " << filename << endl;
+    Logger::print(GL_INFO, "Reading GeoFLOW data from file: " + filename);
 
     // Open file
     ifstream ifs(filename, ios::in | ios::binary);
@@ -128,6 +200,10 @@ void GFileReader<T>::readData(const GString& filename)
         exit(EXIT_FAILURE);
     }
 
+    // Verify the values are the size being read
+    ifs.seekg(0, ios::end);
+    verifyValueBytes(filename, ifs.tellg());
+
     // Set file stream location to start of data and allocate memory
     ifs.seekg(_header.nHeaderBytes);
     _data.resize(_header.nNodesPerVolume);
@@ -136,8 +212,9 @@ void GFileReader<T>::readData(const GString& filename)
     GSIZET nDataBytes = _header.nNodesPerVolume * sizeof(T);
     if (!ifs.read((char*)_data.data(), nDataBytes))
     {
-        cerr << "Error: Cannot read the requested " << nDataBytes
-             << " bytes of data from file: " << filename << endl;
+        string msg = "Cannot read the requested " + to_string(nDataBytes) + \
+                     " bytes of data from file: " + filename;
+        Logger::error(__FILE__, __FUNCTION__, msg);
         ifs.close();
         exit(EXIT_FAILURE);
     }
@@ -145,6 +222,157 @@ void GFileReader<T>::readData(const GString& filename)
     ifs.close();
 }
 
+template <class T>
+void GFileReader<T>::readElementRuns(const GString& filename, 
+                                     const vector<GElemRun>& runs)
+{
+    Logger::print(GL_INFO, "Reading GeoFLOW data of " + to_string(runs.size()) +
+                  " element runs from file: " + filename);
+
+    // Open file
+    int fd = open(filename.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0)
+    {
+        string msg = "Cannot open file: " + filename + " (" + \
+                     strerror(errno) + ")";
+        Logger::error(__FILE__, __FUNCTION__, msg);
+        exit(EXIT_FAILURE);
+    }
+
+    // Verify the values are the size being read and the file holds a value 
+    // for every node in the volume
+    verifyValueBytes(filename, st.st_size);
+    GSIZET nDataBytes = _header.nNodesPerVolume * sizeof(T);
+    if (_header.nHeaderBytes + nDataBytes > (GSIZET)st.st_size)
+    {
+        string msg = "Cannot read the requested " + to_string(nDataBytes) + \
+                     " bytes of data from file: " + filename + " (file " + \
+                     "size is " + to_string(st.st_size) + " bytes)";
+        Logger::error(__FILE__, __FUNCTION__, msg);
+        exit(EXIT_FAILURE);
+    }
+
+    // Allocate memory for the values of all the runs
+    GSIZET nElemBytes = _header.nNodesPerElem * sizeof(T);
+    GSIZET nElems = 0;
+    for (const auto& r : runs)
+    {
+        nElems += r.count;
+    }
+    _data.resize(nElems * _header.nNodesPerElem);
+
+    // Read each run's values into place after the previous run's. Runs in 
+    // file order with small gaps between them are read together with one 
+    // vectored read, since reading a gap costs less than another request: 
+    // the runs' values go straight into place and each gap is read into a 
+    // gap buffer (no larger than the largest gap) and dropped.
+    char* dst = (char*)_data.data();
+    vector<char> gap(G_MAX_READ_GAP_BYTES);
+    vector<struct iovec> iov;
+    GSIZET nReads = 0;
+    for (GSIZET r = 0; r < runs.size(); ++nReads)
+    {
+        GSIZET offset = _header.nHeaderBytes + runs[r].first * nElemBytes;
+        GSIZET nBytes = 0;
+        iov.clear();
+        GSIZET i = r;
+        while (true)
+        {
+            GSIZET n = runs[i].count * nElemBytes;
+            iov.push_back({dst, n});
+            dst += n;
+            nBytes += n;
+            if (++i == runs.size() || iov.size() + 2 > G_MAX_READ_IOVECS)
+            {
+                break;
+            }
+
+            // Join the next run if it follows within the gap limit
+            GSIZET end = runs[i - 1].first + runs[i - 1].count;
+            if (runs[i].first < end || 
+                (runs[i].first - end) * nElemBytes > G_MAX_READ_GAP_BYTES)
+            {
+                break;
+            }
+            GSIZET nGapBytes = (runs[i].first - end) * nElemBytes;
+            if (nGapBytes > 0)
+            {
+                iov.push_back({gap.data(), nGapBytes});
+                nBytes += nGapBytes;
+            }
+        }
+        readBytes(fd, iov, nBytes, offset, filename);
+        r = i;
+    }
+
+    close(fd);
+    Logger::print(GL_DEBUG, "Read " + to_string(runs.size()) + " element " \
+                  "runs with " + to_string(nReads) + " reads");
+}
+
+template <class T>
+void GFileReader<T>::readBytes(int fd, vector<struct iovec>& iov, 
+                               GSIZET nBytes, GSIZET offset, 
+                               const GString& filename)
+{
+    GSIZET done = 0;
+    GSIZET v = 0; // first buffer not yet filled
+    while (done < nBytes)
+    {
+        ssize_t n = preadv(fd, iov.data() + v, 
+                           std::min<GSIZET>(iov.size() - v, IOV_MAX), 
+                           offset + done);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            string msg = "Cannot read the requested " + to_string(nBytes) + \
+                         " bytes of data at byte " + to_string(offset) + \
+                         " from file: " + filename;
+            Logger::error(__FILE__, __FUNCTION__, msg);
+            exit(EXIT_FAILURE);
+        }
+        done += n;
+
+        // Skip the buffers filled by a short read, and move the start of 
+        // one filled in part
+        for (GSIZET left = n; left > 0 && v < iov.size(); )
+        {
+            if (left >= iov[v].iov_len)
+            {
+                left -= iov[v].iov_len;
+                ++v;
+            }
+            else
+            {
+                iov[v].iov_base = (char*)iov[v].iov_base + left;
+                iov[v].iov_len -= left;
+                left = 0;
+            }
+        }
+    }
+}
+
+template <class T>
+void GFileReader<T>::verifyValueBytes(const GString& filename, 
+                                      GSIZET fileSize)
+{
+    // A size of 0 means the file holds more than one value per node, i.e., 
+    // multiple fields
+    GSIZET valueBytes = _header.valueBytes(fileSize);
+    if (valueBytes != 0 && valueBytes != sizeof(T))
+    {
+        string msg = "The data values of file " + filename + " are " + \
+                     to_string(valueBytes) + " bytes each, but are being " \
+                     "read as " + to_string(sizeof(T)) + "-byte values";
+        Logger::error(__FILE__, __FUNCTION__, msg);
+        exit(EXIT_FAILURE);
+    }
+}
+
 template <class T>
 void GFileReader<T>::setElementLayerIDs()
 {
@@ -159,6 +387,22 @@ void GFileReader<T>::setElementLayerIDs()
     }
 }
 
+template <class T>
+void GFileReader<T>::setElementLayerIDs(const vector<GElemRun>& runs)
+{
+    // Use header's element ID array to set an element layer ID for each data 
+    // value, in the order the runs were read
+    _elemLayerIDs.clear();
+    for (const auto& r : runs)
+    {
+        for (GSIZET e = r.first; e < r.first + r.count; ++e)
+        {
+            _elemLayerIDs.insert(_elemLayerIDs.end(), _header.nNodesPerElem,
+                                 GET_LOWORD(_header.elemIDs[e]));
+        }
+    }
+}
+
 template <class T>
 void GFileReader<T>::printData()
 {
@@ -0,0 +1,224 @@
+//==============================================================================
+// Date      : 10/16/26 (agent)
+// Copyright : Copyright 2021. Regents of the University of Colorado.
+//             All rights reserved.
+//==============================================================================
+
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+
+#include "ggrid_cache.h"
+#include "thread_util.h"
+#include "logger.h"
+
+// Identifies a grid cache file and its layout version
+static const char CACHE_MAGIC[8] = {'G', 'F', 'G', 'R', 'I', 'D', 'C', '2'};
+
+// FNV-1a 64-bit offset basis and prime, used as the hash start and multiplier
+static const GSIZET HASH_BASIS = 0xcbf29ce484222325ULL;
+static const GSIZET HASH_PRIME = 0x100000001b3ULL;
+
+// Bytes read from a file per hash step (a multiple of 8)
+static const GSIZET HASH_CHUNK_BYTES = 1 << 22;
+
+template <typename U>
+static void writeValue(ofstream& ofs, const U& value)
+{
+    ofs.write((const char*)&value, sizeof(U));
+}
+
+template <typename U>
+static void writeValues(ofstream& ofs, const vector<U>& values)
+{
+    GSIZET n = values.size();
+    writeValue(ofs, n);
+    ofs.write((const char*)values.data(), n * sizeof(U));
+}
+
+template <typename U>
+static GBOOL readValue(ifstream& ifs, U& value)
+{
+    return (GBOOL)ifs.read((char*)&value, sizeof(U));
+}
+
+template <typename U>
+static GBOOL readValues(ifstream& ifs, vector<U>& values, GSIZET fileSize)
+{
+    GSIZET n = 0;
+    if (!readValue(ifs, n) || n > fileSize / sizeof(U))
+    {
+        return false;
+    }
+    values.resize(n);
+    return (GBOOL)ifs.read((char*)values.data(), n * sizeof(U));
+}
+
+GSIZET GGridCache::fingerprint(const vector<GString>& filenames,
+                               const GString& settings)
+{
+    Logger::info(__FILE__, __FUNCTION__, "Fingerprinting the grid files");
+
+    // Hash the grid files concurrently
+    vector<GSIZET> fileHashes(filenames.size(), 0);
+    vector<std::function<void()>> funcs;
+    for (GSIZET i = 0; i < filenames.size(); ++i)
+    {
+        funcs.push_back([&filenames, &fileHashes, i]()
+        {
+            fileHashes[i] = hashFile(filenames[i]);
+        });
+    }
+    ThreadUtil::runConcurrently(funcs);
+
+    GSIZET h = HASH_BASIS;
+    hashBytes(h, (const char*)fileHashes.data(),
+              fileHashes.size() * sizeof(GSIZET));
+    hashBytes(h, settings.data(), settings.size());
+    return h;
+}
+
+GBOOL GGridCache::read(const GString& filename, GGridCacheData& data)
+{
+    ifstream ifs(filename, ios::in | ios::binary | ios::ate);
+    if (!ifs)
+    {
+        return false;
+    }
+    GSIZET fileSize = ifs.tellg();
+    ifs.seekg(0);
+
+    char magic[sizeof(CACHE_MAGIC)];
+    if (!ifs.read(magic, sizeof(magic)) ||
+        memcmp(magic, CACHE_MAGIC, sizeof(magic)) != 0)
+    {
+        return false;
+    }
+
+    GHeaderInfo& h = data.header;
+    GBOOL ok = readValue(ifs, data.fingerprint) &&
+               readValue(ifs, data.valueBytes) &&
+               readValue(ifs, h.version) &&
+               readValue(ifs, h.dim) &&
+               readValue(ifs, h.nElems) &&
+               readValues(ifs, h.polyOrder, fileSize) &&
+               readValue(ifs, h.gridType) &&
+               readValue(ifs, h.timeCycle) &&
+               readValue(ifs, h.timeStamp) &&
+               readValue(ifs, h.hasMultVars) &&
+               readValues(ifs, h.elemIDs, fileSize) &&
+               readValue(ifs, h.nHeaderBytes) &&
+               readValue(ifs, data.numNodes) &&
+               readValues(ifs, data.reorder, fileSize) &&
+               readValues(ifs, data.outLayers, fileSize) &&
+               readValues(ifs, data.dupLayers, fileSize) &&
+               readValues(ifs, data.outElems, fileSize) &&
+               readValues(ifs, data.readRuns, fileSize) &&
+               readValues(ifs, data.faceNodes, fileSize) &&
+               readValue(ifs, data.gridFileBytes) &&
+               readValue(ifs, data.gridFileMtime);
+    if (!ok)
+    {
+        return false;
+    }
+
+    h.deriveInfo();
+    return true;
+}
+
+void GGridCache::write(const GString& filename, const GGridCacheData& data)
+{
+    GString tmpFilename = filename + ".tmp";
+    ofstream ofs(tmpFilename, ios::out | ios::binary);
+    if (!ofs)
+    {
+        std::string msg = "Cannot write grid cache file: " + tmpFilename;
+        Logger::error(__FILE__, __FUNCTION__, msg);
+        exit(EXIT_FAILURE);
+    }
+
+    const GHeaderInfo& h = data.header;
+    ofs.write(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    writeValue(ofs, data.fingerprint);
+    writeValue(ofs, data.valueBytes);
+    writeValue(ofs, h.version);
+    writeValue(ofs, h.dim);
+    writeValue(ofs, h.nElems);
+    writeValues(ofs, h.polyOrder);
+    writeValue(ofs, h.gridType);
+    writeValue(ofs, h.timeCycle);
+    writeValue(ofs, h.timeStamp);
+    writeValue(ofs, h.hasMultVars);
+    writeValues(ofs, h.elemIDs);
+    writeValue(ofs, h.nHeaderBytes);
+    writeValue(ofs, data.numNodes);
+    writeValues(ofs, data.reorder);
+    writeValues(ofs, data.outLayers);
+    writeValues(ofs, data.dupLayers);
+    writeValues(ofs, data.outElems);
+    writeValues(ofs, data.readRuns);
+    writeValues(ofs, data.faceNodes);
+    writeValue(ofs, data.gridFileBytes);
+    writeValue(ofs, data.gridFileMtime);
+    ofs.close();
+
+    if (!ofs || rename(tmpFilename.c_str(), filename.c_str()) != 0)
+    {
+        std::string msg = "Cannot write grid cache file: " + filename + \
+                          " (" + strerror(errno) + ")";
+        Logger::error(__FILE__, __FUNCTION__, msg);
+        exit(EXIT_FAILURE);
+    }
+    Logger::print(GL_INFO, "Wrote grid cache file: " + filename);
+}
+
+void GGridCache::hashBytes(GSIZET& h, const char* data, GSIZET n)
+{
+    GSIZET i = 0;
+    for (; i + sizeof(GSIZET) <= n; i += sizeof(GSIZET))
+    {
+        GSIZET w;
+        memcpy(&w, data + i, sizeof(GSIZET));
+        h ^= w;
+        h *= HASH_PRIME;
+        h ^= h >> 31;
+    }
+    for (; i < n; ++i)
+    {
+        h ^= (unsigned char)data[i];
+        h *= HASH_PRIME;
+    }
+}
+
+GSIZET GGridCache::hashFile(const GString& filename)
+{
+    ifstream ifs(filename, ios::in | ios::binary);
+    if (!ifs)
+    {
+        std::string msg = "Cannot open file: " + filename;
+        Logger::error(__FILE__, __FUNCTION__, msg);
+        exit(EXIT_FAILURE);
+    }
+
+    GSIZET h = HASH_BASIS;
+    vector<char> buffer(HASH_CHUNK_BYTES);
+    GSIZET size = 0;
+    while (ifs)
+    {
+        ifs.read(buffer.data(), buffer.size());
+        GSIZET n = ifs.gcount();
+        hashBytes(h, buffer.data(), n);
+        size += n;
+    }
+    if (ifs.bad())
+    {
+        std::string msg = "Cannot read file: " + filename;
+        Logger::error(__FILE__, __FUNCTION__, msg);
+        exit(EXIT_FAILURE);
+    }
+
+    // The size separates files whose bytes only differ by trailing zeros
+    hashBytes(h, (const char*)&size, sizeof(size));
+    return h;
+}
@@ -0,0 +1,215 @@
+//==============================================================================
+// Date      : 10/16/26 (agent)
+// Copyright : Copyright 2021. Regents of the University of Colorado.
+//             All rights reserved.
+//==============================================================================
+
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "gmanifest.h"
+#include "logger.h"
+
+// Name of the manifest file in the output directory
+static const char MANIFEST_FILENAME[] = "manifest.txt";
+
+void GManifest::open(const GString& inputDir, const GString& outputDir,
+                     GSIZET fingerprint)
+{
+    _inputDir = inputDir;
+    _outputDir = outputDir;
+    _filename = outputDir + "/" + MANIFEST_FILENAME;
+    _fingerprint = fingerprint;
+    _entries.clear();
+    _staged.clear();
+    readEntries(_entries);
+
+    Logger::print(GL_INFO, "Read " + to_string(_entries.size()) +
+                           " entries from the manifest file: " + _filename);
+}
+
+GBOOL GManifest::isCurrent(const GString& output,
+                           const vector<GString>& sources) const
+{
+    auto it = _entries.find(output);
+    if (it == _entries.end())
+    {
+        return false;
+    }
+    const GManifestEntry& e = it->second;
+
+    GManifestFile f;
+    if (!statFile(_outputDir + "/" + output, f) || f.size != e.output.size ||
+        e.sources.size() != sources.size())
+    {
+        return false;
+    }
+
+    for (GSIZET i = 0; i < sources.size(); ++i)
+    {
+        const GManifestFile& s = e.sources[i];
+        if (s.name != sources[i] || !statFile(_inputDir + "/" + s.name, f) ||
+            f.size != s.size || f.mtime != s.mtime)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void GManifest::stage(const GString& output, const vector<GString>& sources)
+{
+    GManifestEntry e;
+    e.fingerprint = _fingerprint;
+    e.output.name = output;
+    for (const auto& name : sources)
+    {
+        GManifestFile s;
+        if (!statFile(_inputDir + "/" + name, s))
+        {
+            // Reading the missing file reports the error
+            s.size = 0;
+            s.mtime = 0;
+        }
+        s.name = name;
+        e.sources.push_back(s);
+    }
+    _staged[output] = e;
+}
+
+void GManifest::record(const GString& output) const
+{
+    auto it = _staged.find(output);
+    if (!isOpen() || it == _staged.end())
+    {
+        return;
+    }
+
+    GManifestEntry e = it->second;
+    if (!statFile(_outputDir + "/" + output, e.output))
+    {
+        std::string msg = "Cannot find output file: " + output;
+        Logger::error(__FILE__, __FUNCTION__, msg);
+        exit(EXIT_FAILURE);
+    }
+
+    GString line = formatEntry(e);
+    int fd = ::open(_filename.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd < 0 || write(fd, line.data(), line.size()) != (ssize_t)line.size())
+    {
+        std::string msg = "Cannot write manifest file: " + _filename + \
+                          " (" + strerror(errno) + ")";
+        Logger::error(__FILE__, __FUNCTION__, msg);
+        exit(EXIT_FAILURE);
+    }
+    close(fd);
+}
+
+void GManifest::compact() const
+{
+    if (!isOpen())
+    {
+        return;
+    }
+
+    map<GString, GManifestEntry> entries;
+    readEntries(entries);
+
+    GString tmpFilename = _filename + ".tmp";
+    ofstream ofs(tmpFilename);
+    for (const auto& e : entries)
+    {
+        ofs << formatEntry(e.second);
+    }
+    ofs.close();
+
+    if (!ofs || rename(tmpFilename.c_str(), _filename.c_str()) != 0)
+    {
+        std::string msg = "Cannot write manifest file: " + _filename + \
+                          " (" + strerror(errno) + ")";
+        Logger::error(__FILE__, __FUNCTION__, msg);
+        exit(EXIT_FAILURE);
+    }
+    Logger::print(GL_INFO, "Wrote " + to_string(entries.size()) +
+                           " entries to the manifest file: " + _filename);
+}
+
+GBOOL GManifest::statFile(const GString& filename, GManifestFile& file)
+{
+    struct stat st;
+    if (stat(filename.c_str(), &st) != 0)
+    {
+        return false;
+    }
+    file.size = st.st_size;
+    file.mtime = (GLLONG)st.st_mtim.tv_sec * 1000000000LL +
+                 st.st_mtim.tv_nsec;
+    return true;
+}
+
+void GManifest::readEntries(map<GString, GManifestEntry>& entries) const
+{
+    ifstream ifs(_filename);
+    GString line;
+    while (getline(ifs, line))
+    {
+        // fingerprint, output, output size, then name, size, mtime of each
+        // source
+        vector<GString> fields;
+        istringstream iss(line);
+        GString field;
+        while (getline(iss, field, '\t'))
+        {
+            fields.push_back(field);
+        }
+        if (fields.size() < 3 || (fields.size() - 3) % 3 != 0)
+        {
+            continue; // i.e., a line cut short by an interrupted run
+        }
+
+        GManifestEntry e;
+        try
+        {
+            e.fingerprint = stoull(fields[0], 0, 16);
+            e.output.name = fields[1];
+            e.output.size = stoull(fields[2]);
+            e.output.mtime = 0;
+            for (GSIZET i = 3; i < fields.size(); i += 3)
+            {
+                GManifestFile s;
+                s.name = fields[i];
+                s.size = stoull(fields[i + 1]);
+                s.mtime = stoll(fields[i + 2]);
+                e.sources.push_back(s);
+            }
+        }
+        catch (const std::exception&)
+        {
+            continue;
+        }
+
+        if (e.fingerprint == _fingerprint)
+        {
+            entries[e.output.name] = e;
+        }
+    }
+}
+
+GString GManifest::formatEntry(const GManifestEntry& e)
+{
+    ostringstream oss;
+    oss << hex << e.fingerprint << dec << "\t" << e.output.name << "\t"
+        << e.output.size;
+    for (const auto& s : e.sources)
+    {
+        oss << "\t" << s.name << "\t" << s.size << "\t" << s.mtime;
+    }
+    oss << "\n";
+    return oss.str();
+}
@@ -0,0 +1,164 @@
+//==============================================================================
+// Date      : 10/16/26 (agent)
+// Copyright : Copyright 2021. Regents of the University of Colorado.
+//             All rights reserved.
+//==============================================================================
+
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "logger.h"
+
+template <class T>
+GMappedFileReader<T>::GMappedFileReader(const GString& filename)
+{
+    Logger::print(GL_INFO, "Mapping GeoFLOW file: " + filename);
+
+    // Initialize
+    _filename = filename;
+    _map = 0;
+    _fileSize = 0;
+
+    // Open file
+    _fd = open(filename.c_str(), O_RDONLY);
+    if (_fd < 0)
+    {
+        string msg = "Cannot open file: " + filename + " (" + \
+                     strerror(errno) + ")";
+        Logger::error(__FILE__, __FUNCTION__, msg);
+        exit(EXIT_FAILURE);
+    }
+
+    struct stat st;
+    if (fstat(_fd, &st) != 0 || st.st_size == 0)
+    {
+        string msg = "Cannot get the size of (or empty) file: " + filename;
+        Logger::error(__FILE__, __FUNCTION__, msg);
+        exit(EXIT_FAILURE);
+    }
+    _fileSize = st.st_size;
+
+    // Map the whole file read-only; pages are read in by the kernel as they 
+    // are first touched
+    void* addr = mmap(NULL, _fileSize, PROT_READ, MAP_PRIVATE, _fd, 0);
+    if (addr == MAP_FAILED)
+    {
+        string msg = "Cannot map file: " + filename + " (" + \
+                     strerror(errno) + ")";
+        Logger::error(__FILE__, __FUNCTION__, msg);
+        exit(EXIT_FAILURE);
+    }
+    _map = static_cast<char*>(addr);
+    madvise(_map, _fileSize, MADV_SEQUENTIAL);
+
+    // Parse and print header (debug log level)
+    parseHeader();
+    _header.printHeader();
+
+    // Verify the file holds a value for every node in the volume
+    GSIZET nDataBytes = _header.nNodesPerVolume * sizeof(T);
+    if (_header.nHeaderBytes + nDataBytes > _fileSize)
+    {
+        string msg = "Cannot read the requested " + to_string(nDataBytes) + \
+                     " bytes of data from file: " + filename + " (file " + \
+                     "size is " + to_string(_fileSize) + " bytes)";
+        Logger::error(__FILE__, __FUNCTION__, msg);
+        exit(EXIT_FAILURE);
+    }
+
+    // Verify the values are the size being read (a size of 0 means the file 
+    // holds more than one value per node, i.e., multiple fields)
+    GSIZET valueBytes = _header.valueBytes(_fileSize);
+    if (valueBytes != 0 && valueBytes != sizeof(T))
+    {
+        string msg = "The data values of file " + filename + " are " + \
+                     to_string(valueBytes) + " bytes each, but are being " \
+                     "read as " + to_string(sizeof(T)) + "-byte values";
+        Logger::error(__FILE__, __FUNCTION__, msg);
+        exit(EXIT_FAILURE);
+    }
+
+    // View the data values in place
+    _data = GSpan<T>(_map + _header.nHeaderBytes, _header.nNodesPerVolume);
+}
+
+template <class T>
+GMappedFileReader<T>::~GMappedFileReader()
+{
+    // Unmap and close file
+    if (_map != 0)
+    {
+        munmap(_map, _fileSize);
+    }
+    if (_fd >= 0)
+    {
+        close(_fd);
+    }
+}
+
+template <class T>
+template <typename U>
+void GMappedFileReader<T>::readValue(GSIZET& pos, U& value)
+{
+    if (pos + sizeof(U) > _fileSize)
+    {
+        string msg = "Header of file: " + _filename + " is truncated.";
+        Logger::error(__FILE__, __FUNCTION__, msg);
+        exit(EXIT_FAILURE);
+    }
+    memcpy(&value, _map + pos, sizeof(U));
+    pos += sizeof(U);
+}
+
+template <class T>
+void GMappedFileReader<T>::parseHeader()
+{
+    // Read header info (same layout as read by GFileReader::readHeader)
+    GHeaderInfo& h = _header;
+    GSIZET pos = 0;
+    readValue(pos, h.version);
+    readValue(pos, h.dim);
+    readValue(pos, h.nElems);
+
+    // Verify data
+    if (h.dim < 2 || h.dim > 3)
+    {
+        string msg = "Found (" + to_string(h.dim) + ") polynomial orders " + \
+                     "in file: " + _filename + ". Need 2 or 3 (for each " + \
+                     "x, y & z reference direction).";
+        Logger::error(__FILE__, __FUNCTION__, msg);
+        exit(EXIT_FAILURE);
+    }
+
+    h.polyOrder.resize(h.dim); // each ref dir has its own poly order
+    for (auto& p : h.polyOrder)
+    {
+        readValue(pos, p);
+    }
+
+    readValue(pos, h.gridType);
+    readValue(pos, h.timeCycle);
+    readValue(pos, h.timeStamp);
+    readValue(pos, h.hasMultVars);
+
+    if (h.nElems == 0 || h.nElems > (_fileSize - pos) / sizeof(GSIZET))
+    {
+        string msg = "Invalid number of elements (" + to_string(h.nElems) + \
+                     ") in file: " + _filename;
+        Logger::error(__FILE__, __FUNCTION__, msg);
+        exit(EXIT_FAILURE);
+    }
+    h.elemIDs.resize(h.nElems);
+    memcpy(h.elemIDs.data(), _map + pos, h.nElems * sizeof(GSIZET));
+    pos += h.nElems * sizeof(GSIZET);
+
+    // Get total byte size of header
+    h.nHeaderBytes = pos;
+
+    // Get the auxiliary data derived from the header
+    h.deriveInfo();
+}
@@ -0,0 +1,179 @@
+//==============================================================================
+// Date      : 10/16/26 (agent)
+// Copyright : Copyright 2021. Regents of the University of Colorado.
+//             All rights reserved.
+//==============================================================================
+
+#include "gschema.h"
+#include "logger.h"
+
+void GSchema::compile(const pt::ptree& root)
+{
+    Logger::info(__FILE__, __FUNCTION__, "Compiling NetCDF dimensions and " \
+                 "variables from the property tree");
+
+    _dims.clear();
+    _vars.clear();
+    _dimHandles.clear();
+    _varHandles.clear();
+    _dataType = PTUtil::getValue<GString>(root, "data_type", "");
+
+    // For each dimension in the dimensions array...
+    pt::ptree dimArr = PTUtil::getArray(root, "dimensions");
+    for (pt::ptree::iterator it = dimArr.begin(); it != dimArr.end(); ++it)
+    {
+        GSchemaDimension dim;
+        dim.name = PTUtil::getValue<GString>(it->second, "name");
+        dim.value = PTUtil::getValue<GSIZET>(it->second, "value");
+        _dimHandles[dim.name] = _dims.size();
+        _dims.push_back(dim);
+    }
+
+    // For each variable in the variables array...
+    pt::ptree varArr = PTUtil::getArray(root, "variables");
+    for (pt::ptree::iterator it = varArr.begin(); it != varArr.end(); ++it)
+    {
+        GSchemaVariable var;
+        var.name = PTUtil::getValue<GString>(it->second, "name");
+        var.type = resolveType(PTUtil::getValue<GString>(it->second, "type"));
+
+        // Resolve the variable's dimension names into handles
+        pt::ptree argsArr = PTUtil::getArray(it->second, "args");
+        for (auto a : PTUtil::getValues<GString>(argsArr))
+        {
+            if (!hasDimension(a))
+            {
+                std::string msg = "The dimension (" + a + ") of variable " \
+                                  "(" + var.name + ") is not in the " \
+                                  "dimensions array of the property tree.";
+                Logger::error(__FILE__, __FUNCTION__, msg);
+                exit(EXIT_FAILURE);
+            }
+            var.dims.push_back(dimensionHandle(a));
+        }
+
+        // Read the variable's attributes
+        pt::ptree attArr = PTUtil::getArray(it->second, "attributes");
+        for (pt::ptree::iterator itAtt = attArr.begin();
+             itAtt != attArr.end();
+             ++itAtt)
+        {
+            GSchemaAttribute att;
+            att.name = PTUtil::getValue<GString>(itAtt->second, "name");
+            att.value = PTUtil::getValue<GString>(itAtt->second, "value");
+
+            // GString is the default type for an attribute value
+            att.type = resolveType(PTUtil::getValue<GString>(itAtt->second,
+                                                            "type",
+                                                            "GString"));
+            var.attributes.push_back(att);
+        }
+
+        var.storage = readStorage(it->second, root);
+        _varHandles[var.name] = _vars.size();
+        _vars.push_back(var);
+    }
+}
+
+const GSchemaDimension& GSchema::dimension(GUINT handle) const
+{
+    return _dims[handle];
+}
+
+const GSchemaVariable& GSchema::variable(GUINT handle) const
+{
+    return _vars[handle];
+}
+
+GBOOL GSchema::hasDimension(const GString& name) const
+{
+    return _dimHandles.find(name) != _dimHandles.end();
+}
+
+GBOOL GSchema::hasVariable(const GString& name) const
+{
+    return _varHandles.find(name) != _varHandles.end();
+}
+
+GUINT GSchema::dimensionHandle(const GString& name) const
+{
+    auto it = _dimHandles.find(name);
+    if (it == _dimHandles.end())
+    {
+        std::string msg = "Could not find dimension (" + name + ") in the " \
+                          "property tree.";
+        Logger::error(__FILE__, __FUNCTION__, msg);
+        exit(EXIT_FAILURE);
+    }
+    return it->second;
+}
+
+GUINT GSchema::variableHandle(const GString& name) const
+{
+    auto it = _varHandles.find(name);
+    if (it == _varHandles.end())
+    {
+        std::string msg = "Could not find the variable (" + name + ") in " \
+                          "the property tree.";
+        Logger::error(__FILE__, __FUNCTION__, msg);
+        exit(EXIT_FAILURE);
+    }
+    return it->second;
+}
+
+void GSchema::setDimensionValue(GUINT handle, GSIZET value)
+{
+    _dims[handle].value = value;
+}
+
+GString GSchema::resolveType(const GString& type) const
+{
+    if (type != "data_type")
+    {
+        return type;
+    }
+
+    if (_dataType.empty())
+    {
+        std::string msg = "A type of data_type is used but data_type is not " \
+                          "set in the property tree.";
+        Logger::error(__FILE__, __FUNCTION__, msg);
+        exit(EXIT_FAILURE);
+    }
+    return _dataType;
+}
+
+GSchemaStorage GSchema::readStorage(const pt::ptree& varTree,
+                                    const pt::ptree& root) const
+{
+    GSchemaStorage s;
+    s.deflateLevel = PTUtil::getValue<GUINT>(varTree,
+        "storage.deflate_level",
+        PTUtil::getValue<GUINT>(root, "storage.deflate_level", 0));
+    s.shuffle = PTUtil::getValue<GBOOL>(varTree, "storage.shuffle",
+        PTUtil::getValue<GBOOL>(root, "storage.shuffle", false));
+    s.quantizeDigits = PTUtil::getValue<GINT>(varTree,
+        "storage.quantize_digits",
+        PTUtil::getValue<GINT>(root, "storage.quantize_digits", 0));
+
+    // Use the variable's chunks array, or else the top-level one
+    const pt::ptree* chunkArr = NULLPTR;
+    if (varTree.get_child_optional("storage.chunks"))
+    {
+        chunkArr = &varTree.get_child("storage.chunks");
+    }
+    else if (root.get_child_optional("storage.chunks"))
+    {
+        chunkArr = &root.get_child("storage.chunks");
+    }
+
+    s.hasChunks = (chunkArr != NULLPTR);
+    if (s.hasChunks)
+    {
+        BOOST_FOREACH (const pt::ptree::value_type& c, *chunkArr)
+        {
+            s.chunks.push_back(c.second.get_value<GSIZET>());
+        }
+    }
+    return s;
+}
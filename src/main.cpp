@@ -5,29 +5,115 @@
 //                All rights reserved.
 //==============================================================================
 
+#include <set>
+#include <csignal>
+#include <cstring>
+
 #include "gdata_converter.h"
+#include "process_util.h"
+#include "mpi_util.h"
+#include "gprofiler.h"
+#include "gmanifest.h"
+#include "gdir_watcher.h"
+#include "gdataset_validator.h"
 #include "timer.h"
 
-#define GDATATYPE GDOUBLE
 #define G_FILE_EXT ".out"
 #define NC_FILE_EXT ".nc"
 
 // Global variables
 GString jsonFile;
-GDOUBLE startTime = 0, endTime = 0;
+GString checkMode; // "--validate" or "--inspect" to only check the files
+GProfiler prof;
+GManifest manifest;
+volatile sig_atomic_t stopFollowing = 0;
 
 void parseCommandLine(int argc, char** argv);
 void usage(char programName[]);
+GSIZET gridValueBytes();
+template <typename T>
+void convert();
+template <typename T>
+GString outputFilename(const GDataConverter<T>& gdc,
+                       const GString& fullVarName);
+template <typename T>
+vector<GString> pendingFieldVariables(const GDataConverter<T>& gdc,
+                                      const vector<GString>& fullVarNames);
+template <typename T>
+void writeGrid(GDataConverter<T>& gdc, const GString& ncFilename);
+template <typename T>
+GSIZET readFieldVariables(GDataConverter<T>& gdc,
+                          const vector<GString>& fullVarNames,
+                          map<GString, GHeaderInfo>& timeHeaderMap);
+template <typename T>
+vector<GString> writeFieldVariables(GDataConverter<T>& gdc,
+                                    const vector<GString>& fullVarNames,
+                                    const map<GString, GHeaderInfo>& timeHeaderMap);
+template <typename T>
+void convertTimestep(GDataConverter<T>& gdc,
+                     const GString& timestep,
+                     const vector<GString>& fullVarNames);
+template <typename T>
+void followInputDir(GDataConverter<T>& gdc);
+void onStopSignal(int signal);
+template <typename T>
+void writeProfileReport(const GDataConverter<T>& gdc);
 
 int main(int argc, char** argv)
 {
+    // Initialize MPI (does nothing unless built with GEOFLOW_USE_MPI)
+    MPIUtil::init(&argc, &argv);
+
     // Parse command line arguments
     parseCommandLine(argc, argv);
 
+    // Only check the GeoFLOW files (from their headers) and report the 
+    // problems found, without converting them
+    if (!checkMode.empty())
+    {
+        GSIZET nErrors = 0;
+        if (MPIUtil::rank() == 0)
+        {
+            GDatasetValidator validator(jsonFile);
+            nErrors = validator.validate();
+            validator.writeReport(cout, checkMode == "--inspect");
+        }
+        Logger::flush();
+        MPIUtil::finalize();
+        return nErrors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // Convert with node values of the type the grid files store (float or 
+    // double). Rank 0 reads it from the x grid file and shares it.
+    GSIZET valueBytes = 0;
+    if (MPIUtil::rank() == 0)
+    {
+        valueBytes = gridValueBytes();
+    }
+    MPIUtil::broadcast(valueBytes);
+    if (valueBytes == sizeof(GFLOAT))
+    {
+        convert<GFLOAT>();
+    }
+    else
+    {
+        convert<GDOUBLE>();
+    }
+
+    Logger::flush();
+    MPIUtil::finalize();
+    return 0;
+}
+
+template <typename T>
+void convert()
+{
     // Initialize the GeoFLOW data converter with the JSON file (property 
     // tree) that contains metadata for the GeoFLOW dataset and for writing 
     // NetCDF-UGRID files
-    GDataConverter<GDATATYPE> gdc(jsonFile);
+    GDataConverter<T> gdc(jsonFile);
+    Logger::print(GL_INFO, "Converting with " + to_string(sizeof(T)) + 
+                           "-byte node values");
   
     ///////////////////////////////////
     //// READ COORDINATE VARIABLES ////
@@ -37,207 +123,640 @@ int main(int argc, char** argv)
     // specified in the JSON file, and store in a collection of nodes. The 
     // args passed in correspond to the grid variable names in the JSON file 
     // that will store grid values.
-    startTime = Timer::getTime();
+    // With MPI, rank 0 reads the grid and copies it to the other ranks.
+    // With the grid cache, a grid unchanged since it was cached is loaded 
+    // instead, and the grid work below is skipped.
+    prof.start("grid_read");
     GHeaderInfo gridHeader;
-    if (gdc.is_spherical())
+    GBOOL gridCached = false;
+    if (MPIUtil::rank() == 0 && gdc.do_use_grid_cache())
     {
-        // Dataset is a spherical grid. x,y,z values will get converted to 
-        // lat,lon,radius. (mesh_node_x=lon, mesh_node_y=lat, mesh_depth=radius)
-        gridHeader = gdc.readGFGridToLatLonRadNodes("mesh_node_y", "mesh_node_x", "mesh_depth");
+        gridCached = gdc.loadGridCache();
+        gridHeader = gdc.header();
     }
-    else
+    if (MPIUtil::rank() == 0 && !gridCached)
     {
-        // Dataset is a box grid. No conversion of x,y,z value occurs.
-        // (mesh_node_x=x-axis, mesh_node_y=y-axis, mesh_depth=radius) 
-        gridHeader = gdc.readGFGridToBoxNodes("mesh_node_x", "mesh_node_y", "mesh_depth");
+        if (gdc.is_spherical())
+        {
+            // Dataset is a spherical grid. x,y,z values will get converted to 
+            // lat,lon,radius. (mesh_node_x=lon, mesh_node_y=lat, mesh_depth=radius)
+            gridHeader = gdc.readGFGridToLatLonRadNodes("mesh_node_y", "mesh_node_x", "mesh_depth");
+        }
+        else
+        {
+            // Dataset is a box grid. No conversion of x,y,z value occurs.
+            // (mesh_node_x=x-axis, mesh_node_y=y-axis, mesh_depth=radius) 
+            gridHeader = gdc.readGFGridToBoxNodes("mesh_node_x", "mesh_node_y", "mesh_depth");
+        }
+
+        // Select the part of the grid to convert, so only its elements are 
+        // read from the field variable files
+        if (gdc.do_subset())
+        {
+            gdc.selectSubset("mesh_node_x", "mesh_node_y", "mesh_depth");
+        }
+    }
+    if (MPIUtil::size() > 1)
+    {
+        MPIUtil::broadcast(gridCached);
+        gridHeader = gdc.broadcastGrid();
     }
     gridHeader.printHeader();
-    endTime = Timer::getTime();
-    Timer::printElapsedTime(startTime, endTime, "after reading GF grid to nodes");
-
-    // Set any 0-valued dimensions in the JSON file with the info read in from 
-    // the header of a GeoFLOW grid file
-    map<GString, GSIZET> dims;
-    dims["nMeshNodes"] = gridHeader.nNodesPer2DLayer;
-    dims["nMeshFaces"] = gridHeader.nFacesPer2DLayer;
-    dims["meshLayers"] = gridHeader.n2DLayers;
-    gdc.setDimensions(dims);
+    GSIZET gridBytes = 0;
+    if (MPIUtil::rank() == 0)
+    {
+        gridBytes = gdc.inputFileBytes(gdc.gridFilenames());
+    }
+    prof.stop(3 * gdc.nodes().size(), gridBytes);
 
     //////////////////////////////
     //// READ FIELD VARIABLES ////
     //////////////////////////////
 
-    // Read the field variables specified in the JSON file into the collection 
-    // of nodes. Save the headers for each timestep so time stamp can be 
-    // extracted later on. The full variable names are of the form 
-    // rootVarName.timestep
+    // Save the headers for each timestep so time stamp can be extracted 
+    // later on
     map<GString, GHeaderInfo> timeHeaderMap;
 
-    // For each GeoFLOW variable...
-    startTime = Timer::getTime();
-    for (auto fullVarName : gdc.fieldVarNames())
+    // The field variables converted by this rank (all of them without MPI). 
+    // When following, the timesteps are found in the input directory 
+    // instead.
+    vector<GString> fieldVarNames;
+    if (!gdc.do_follow())
     {
-        cout << "Reading GeoFLOW variable: " << fullVarName << endl;
+        fieldVarNames = gdc.localFieldVarNames();
+    }
 
-        // Read the variable into the collection of nodes
-        GString gfFilename = fullVarName + G_FILE_EXT;
-        GString timestep = gdc.extractTimestep(fullVarName);
-        timeHeaderMap[timestep] = gdc.readGFVariableToNodes(gfFilename, 
-                                                            fullVarName);
+    // An incremental conversion only converts the output files that are 
+    // missing from the manifest or whose GeoFLOW files changed since they 
+    // were written. Every rank checks its own outputs against the 
+    // fingerprint rank 0 computed.
+    if (gdc.do_incremental())
+    {
+        GSIZET fingerprint = 0;
+        if (MPIUtil::rank() == 0)
+        {
+            fingerprint = gdc.gridFingerprint();
+        }
+        MPIUtil::broadcast(fingerprint);
+        manifest.open(gdc.inputDir(), gdc.outputDir(), fingerprint);
+        if (!gdc.do_follow())
+        {
+            fieldVarNames = pendingFieldVariables(gdc, fieldVarNames);
+        }
+    }
+
+    // When streaming, each timestep is read and written after the grid is 
+    // written instead
+    if (!gdc.do_stream_timesteps())
+    {
+        prof.start("field_read");
+        GSIZET bytes = readFieldVariables(gdc, fieldVarNames, timeHeaderMap);
+        prof.stop(fieldVarNames.size() * gdc.nodes().size(), bytes);
     }
-    endTime = Timer::getTime();
-    Timer::printElapsedTime(startTime, endTime, "after reading all GF field variables to nodes");
 
     ////////////////////
     //// SORT NODES ////
     ////////////////////
 
-    // Sort the nodes into ascending order of element ids
-    startTime = Timer::getTime();
-    gdc.sortNodesByElemID();
-    endTime = Timer::getTime();
-    Timer::printElapsedTime(startTime, endTime, "after sorting nodes by element ID");
-
-    // Sort the nodes into ascending order of 2D mesh layers
-    startTime = Timer::getTime();
-    gdc.sortNodesBy2DMeshLayer();
-    endTime = Timer::getTime();
-    Timer::printElapsedTime(startTime, endTime, "after sorting nodes by 2D mesh layer");
-
-    // Create a list of face to node mappings for one mesh layer (all mesh 
-    // layers have the same mapping)
-    startTime = Timer::getTime();
-    gdc.faceToNodes();
-    endTime = Timer::getTime();
-    Timer::printElapsedTime(startTime, endTime, "after creating a list of face to nodes mappings");
-
-    startTime = Timer::getTime();
-    cout << "Creating a single list of face indices" << endl;
-    vector<GUINT> faceList;
-    for (auto f : gdc.faces())
-    {
-        for (auto i : f.indices())
+    // Nodes reordered by permutation were already scattered into their 
+    // sorted positions while reading
+    if (!gdc.do_reorder_by_permutation())
+    {
+        // Sort the nodes into ascending order of element ids
+        prof.start("sort_by_elem_id");
+        gdc.sortNodesByElemID();
+        prof.stop(gdc.nodes().size());
+
+        // Sort the nodes into ascending order of 2D mesh layers
+        prof.start("sort_by_2d_mesh_layer");
+        gdc.sortNodesBy2DMeshLayer();
+        prof.stop(gdc.nodes().size());
+    }
+
+    // Find the 2D mesh layers shared by adjacent element layers so each one 
+    // only gets written once (a cached grid already has them)
+    if (gdc.do_remove_duplicate_layers() && !gridCached)
+    {
+        gdc.findDuplicate2DMeshLayers("mesh_depth");
+    }
+
+    // Set any 0-valued dimensions in the JSON file with the info read in from 
+    // the header of a GeoFLOW grid file, at the output directory's level of 
+    // detail
+    gdc.setLODLevel(0);
+
+    // The grid is only written once, by rank 0, and not again while the 
+    // cached grid.nc is current
+    if (MPIUtil::rank() == 0 && !gridCached)
+    {
+        // Create the face to node mapping for one mesh layer (all mesh 
+        // layers have the same mapping) as a flat buffer of node indices
+        prof.start("face_to_nodes");
+        gdc.faceToNodes();
+        const vector<GUINT>& faceList = gdc.faceNodes();
+        prof.stop(gdc.numFaces());
+
+        ///////////////////////////////////////////
+        //// WRITE GRID / COORDINATE VARIABLES ////
+        ///////////////////////////////////////////
+
+        prof.start("grid_write");
+        writeGrid(gdc, "grid.nc");
+        prof.stop(faceList.size() + 3 * gdc.nodes().size(), 0, 
+                  gdc.outputFileBytes({"grid.nc"}));
+
+        if (gdc.do_use_grid_cache())
+        {
+            gdc.saveGridCache();
+        }
+
+        // Write the grid at each coarser level of detail of the pyramid 
+        // into the level's directory
+        if (gdc.numLODLevels() > 1)
+        {
+            prof.start("lod_grid_write");
+            vector<GString> ncFilenames;
+            for (GSIZET l = 1; l < gdc.numLODLevels(); ++l)
+            {
+                gdc.setLODLevel(l);
+                gdc.faceToNodes();
+                ncFilenames.push_back(gdc.lodLevelDir(l) + "grid.nc");
+                writeGrid(gdc, ncFilenames.back());
+            }
+            gdc.setLODLevel(0);
+            prof.stop(gdc.numLODLevels() - 1, 0, 
+                      gdc.outputFileBytes(ncFilenames));
+        }
+    }
+
+    ///////////////////////////////////
+    ////// WRITE FIELD VARIABLES //////
+    ///////////////////////////////////
+
+    if (gdc.do_stream_timesteps())
+    {
+        // Group the field variables by timestep
+        map<GString, vector<GString>> timestepVarNames;
+        for (auto fullVarName : fieldVarNames)
         {
-          faceList.push_back(i);
+            timestepVarNames[gdc.extractTimestep(fullVarName)].push_back(
+                                                                fullVarName);
+        }
+
+        // For each timestep, read its field variables, write them to (an) 
+        // nc file(s) and release their node data before the next timestep
+        for (auto t : timestepVarNames)
+        {
+            convertTimestep(gdc, t.first, t.second);
         }
     }
-    endTime = Timer::getTime();
-    Timer::printElapsedTime(startTime, endTime, "after creating a single list of face indices");
+    else
+    {
+        prof.start("field_write");
+        vector<GString> ncFilenames = writeFieldVariables(gdc, fieldVarNames, 
+                                                          timeHeaderMap);
+        prof.stop(fieldVarNames.size() * gdc.nodes().size(), 0, 
+                  gdc.outputFileBytes(ncFilenames));
+    }
 
-    ///////////////////////////////////////////
-    //// WRITE GRID / COORDINATE VARIABLES ////
-    ///////////////////////////////////////////
+    // Convert each new timestep as the simulation writes it, with the grid 
+    // kept in memory
+    if (gdc.do_follow())
+    {
+        followInputDir(gdc);
+    }
 
-    startTime = Timer::getTime();
+    // Keep one entry per output in the manifest once every rank has 
+    // recorded its outputs
+    if (gdc.do_incremental())
+    {
+        MPIUtil::barrier();
+        if (MPIUtil::rank() == 0)
+        {
+            manifest.compact();
+        }
+    }
+
+    // Write the measurements of each stage next to the output files
+    if (gdc.do_write_profile())
+    {
+        writeProfileReport(gdc);
+    }
+
+    // For debugging; the node list goes straight to stdout, after any 
+    // queued log messages
+    if (gdc.do_print_nodes() && MPIUtil::rank() == 0)
+    {
+        Logger::flush();
+        cout << "Node List: #=sorted node pos | sortID=orig node pos | eID=GF element layer ID | grid and field vars\n"
+             << "---------------------------------------------------------------------------------------------------\n";
+        for (GSIZET i = 0; i < gdc.nodes().size(); ++i)
+        {    
+            cout << i << " - ";
+            gdc.nodes().printNode(i, gdc.allVarNames());
+        }
+    }
+}
+
+GSIZET gridValueBytes()
+{
+    pt::ptree root;
+    PTUtil::readJSONFile(jsonFile, root);
+    GString filename = PTUtil::getValue<GString>(root, "input_dir") + "/" + 
+                       PTUtil::getValue<GString>(root, "grid_filenames.x");
+
+    // Files whose size does not tell are read as double
+    GSIZET valueBytes = GFileReader<GDOUBLE>::readValueBytes(filename);
+    if (valueBytes == 0)
+    {
+        valueBytes = sizeof(GDOUBLE);
+    }
+    return valueBytes;
+}
+
+template <typename T>
+void writeGrid(GDataConverter<T>& gdc, const GString& ncFilename)
+{
     // Initialize a NetCDF file to store all time-invariant grid variables
-    gdc.initNC("grid.nc", NcFile::FileMode::replace);
+    gdc.initNC(ncFilename, NcFile::FileMode::replace);
     gdc.writeNCDimensions();
 
     // Write the grid variables to the active NetCDF file
     gdc.writeNCDummyVariable("mesh");
-    gdc.writeNCVariable("mesh_face_nodes", faceList);
+    gdc.writeNCVariable("mesh_face_nodes", gdc.faceNodes());
     gdc.writeNCNodeVariable("mesh_node_x", "mesh_node_x");
     gdc.writeNCNodeVariable("mesh_node_y", "mesh_node_y");
     gdc.writeNCNodeVariable("mesh_depth", "mesh_depth");
 
     // Close the active NetCDF file
     gdc.closeNC();
-    endTime = Timer::getTime();
-    Timer::printElapsedTime(startTime, endTime, "after writing the grid variables to an nc file");
+}
 
-    ///////////////////////////////////
-    ////// WRITE FIELD VARIABLES //////
-    ///////////////////////////////////
+template <typename T>
+GSIZET readFieldVariables(GDataConverter<T>& gdc,
+                          const vector<GString>& fullVarNames,
+                          map<GString, GHeaderInfo>& timeHeaderMap)
+{
+    // Read the field variables specified in the JSON file into the collection 
+    // of nodes. The full variable names are of the form rootVarName.timestep
+    vector<GString> gfFilenames;
+    for (auto fullVarName : fullVarNames)
+    {
+        gfFilenames.push_back(fullVarName + G_FILE_EXT);
+    }
 
-    startTime = Timer::getTime();
-    // For a given timestep, write each field variable to a separate file
-    if (gdc.do_write_separate_var_files())
+    // Read the variables (concurrently if configured) into the collection 
+    // of nodes
+    vector<GHeaderInfo> headers = gdc.readGFVariablesToNodes(gfFilenames,
+                                                             fullVarNames);
+
+    // For each GeoFLOW variable...
+    for (auto i = 0u; i < fullVarNames.size(); ++i)
     {
-        // For each field variable...
-        for (auto fullVarName : gdc.fieldVarNames())
-        {
-            cout << "Converting GeoFLOW variable to nc file: " << fullVarName 
-                 << endl;
-
-            // Initialize a NetCDF file for this timestep to store this field 
-            // variable
-            GString ncFilename = fullVarName + NC_FILE_EXT;
-            gdc.initNC(ncFilename, NcFile::FileMode::replace);
-            gdc.writeNCDimensions();
-
-            // Write the time stamp variable to the active NetCDF file
-            GString timestep = gdc.extractTimestep(fullVarName);
-            gdc.writeNCVariable("time", timeHeaderMap[timestep].timeStamp);
-
-            // Write the field variable to the active NetCDF file
-            GString rootVarName = gdc.extractRootVarName(fullVarName);
-            gdc.writeNCNodeVariable(rootVarName, fullVarName);
-   
-            // Close the active NetCDF file
-            gdc.closeNC();
-        }
+        GString timestep = gdc.extractTimestep(fullVarNames[i]);
+        timeHeaderMap[timestep] = headers[i];
     }
-    else // for a given timestep, write all field variables to the same file
+
+    return gdc.inputFileBytes(gfFilenames);
+}
+
+template <typename T>
+vector<GString> writeFieldVariables(GDataConverter<T>& gdc,
+                                    const vector<GString>& fullVarNames,
+                                    const map<GString, GHeaderInfo>& timeHeaderMap)
+{
+    // Each output file is independent, so each one is written by its own 
+    // task. The tasks run in separate processes when configured, which 
+    // keeps each process's NetCDF/HDF5 library state private.
+    vector<std::function<void()>> tasks;
+    vector<GString> ncFilenames;
+
+    // Each output file is written at the output directory's level of 
+    // detail, and again into the directory of each level of the pyramid
+    for (GSIZET level = 0; level < gdc.numLODLevels(); ++level)
     {
-        // For each timestep...
-        for (auto t : timeHeaderMap)
+        GString dir = gdc.lodLevelDir(level);
+
+        // For a given timestep, write each field variable to a separate file
+        if (gdc.do_write_separate_var_files())
         {
-            // Get timestep as a string
-            GBOOL wroteTimeStamp = false;
-            GString timestep = t.first;
-
-            // Initialize a NetCDF file for this timestep to store all the  
-            // field variables
-            GString ncFilename = "vars." + timestep + NC_FILE_EXT;
-            gdc.initNC(ncFilename, NcFile::FileMode::replace);
-            gdc.writeNCDimensions();
-
-            // For each variable at this timestep...
-            for (auto fullVarName : gdc.fieldVarNames())
+            // For each field variable...
+            for (auto fullVarName : fullVarNames)
             {
-                if (fullVarName.find(timestep) != string::npos)
+                GString ncFilename = dir + outputFilename(gdc, fullVarName);
+                ncFilenames.push_back(ncFilename);
+                tasks.push_back([&gdc, &timeHeaderMap, fullVarName, 
+                                 ncFilename, level]()
                 {
-                    cout << "Converting GeoFLOW variable to nc file: " 
-                         << fullVarName << endl;
+                    Logger::print(GL_INFO, "Converting GeoFLOW variable to " \
+                                  "nc file: " + fullVarName);
+                    gdc.setLODLevel(level);
 
-                    if (!wroteTimeStamp)
-                    {
-                        // Write the time stamp variable to the active NetCDF 
-                        // file; since all vars getting written to the same 
-                        // file, only want to write the time stamp variable 
-                        // once
-                        gdc.writeNCVariable("time", (t.second).timeStamp);
-                        wroteTimeStamp = true;
-                    }
+                    // Initialize a NetCDF file for this timestep to store 
+                    // this field variable
+                    gdc.initNC(ncFilename, NcFile::FileMode::replace);
+                    gdc.writeNCDimensions();
+
+                    // Write the time stamp variable to the active NetCDF file
+                    GString timestep = gdc.extractTimestep(fullVarName);
+                    gdc.writeNCVariable("time", 
+                                        timeHeaderMap.at(timestep).timeStamp);
 
                     // Write the field variable to the active NetCDF file
                     GString rootVarName = gdc.extractRootVarName(fullVarName);
                     gdc.writeNCNodeVariable(rootVarName, fullVarName);
-                }
+    
+                    // Close the active NetCDF file
+                    gdc.closeNC();
+                    manifest.record(ncFilename);
+                });
+            }
+        }
+        else // for a given timestep, write all field variables to the same 
+             // file
+        {
+            // For each timestep...
+            for (auto t : timeHeaderMap)
+            {
+                GString ncFilename = dir + "vars." + t.first + NC_FILE_EXT;
+                ncFilenames.push_back(ncFilename);
+                tasks.push_back([&gdc, &fullVarNames, t, ncFilename, level]()
+                {
+                    // Get timestep as a string
+                    GBOOL wroteTimeStamp = false;
+                    GString timestep = t.first;
+                    gdc.setLODLevel(level);
+
+                    // Initialize a NetCDF file for this timestep to store all 
+                    // the field variables
+                    gdc.initNC(ncFilename, NcFile::FileMode::replace);
+                    gdc.writeNCDimensions();
+
+                    // For each variable at this timestep...
+                    for (auto fullVarName : fullVarNames)
+                    {
+                        if (fullVarName.find(timestep) != string::npos)
+                        {
+                            Logger::print(GL_INFO, "Converting GeoFLOW " \
+                                          "variable to nc file: " + 
+                                          fullVarName);
+
+                            if (!wroteTimeStamp)
+                            {
+                                // Write the time stamp variable to the 
+                                // active NetCDF file; since all vars getting 
+                                // written to the same file, only want to 
+                                // write the time stamp variable once
+                                gdc.writeNCVariable("time", 
+                                                    (t.second).timeStamp);
+                                wroteTimeStamp = true;
+                            }
+
+                            // Write the field variable to the active NetCDF 
+                            // file
+                            GString rootVarName = 
+                                gdc.extractRootVarName(fullVarName);
+                            gdc.writeNCNodeVariable(rootVarName, fullVarName);
+                        }
+                    }
+                
+                    // Close the active NetCDF file
+                    gdc.closeNC();
+                    manifest.record(ncFilename);
+                });
             }
-            
-            // Close the active NetCDF file
-            gdc.closeNC();
         }
     }
-    endTime = Timer::getTime();
-    Timer::printElapsedTime(startTime, endTime, "after writing all field variables to (an) nc file(s)");
 
-    // For debugging
-    if (gdc.do_print_nodes())
+    ProcessUtil::runInProcesses(tasks, gdc.numWriterProcesses());
+    gdc.setLODLevel(0);
+    return ncFilenames;
+}
+
+template <typename T>
+void convertTimestep(GDataConverter<T>& gdc,
+                     const GString& timestep,
+                     const vector<GString>& fullVarNames)
+{
+    Logger::print(GL_INFO, "Streaming GeoFLOW timestep: " + timestep);
+
+    GSIZET numValues = fullVarNames.size() * gdc.nodes().size();
+    map<GString, GHeaderInfo> stepHeaderMap;
+    prof.start("field_read");
+    GSIZET bytes = readFieldVariables(gdc, fullVarNames, stepHeaderMap);
+    prof.stop(numValues, bytes);
+
+    prof.start("field_write");
+    vector<GString> ncFilenames = writeFieldVariables(gdc, fullVarNames, 
+                                                      stepHeaderMap);
+    prof.stop(numValues, 0, gdc.outputFileBytes(ncFilenames));
+    for (auto fullVarName : fullVarNames)
     {
-        cout << "Node List: #=sorted node pos | sortID=orig node pos | eID=GF element layer ID | grid and field vars\n"
-             << "---------------------------------------------------------------------------------------------------\n";
-        GSIZET count = 0;
-        for (auto n : gdc.nodes())
-        {    
-            cout << count << " - ";
-            n.printNode(gdc.allVarNames());
-            ++count;
+        gdc.releaseNodeVariable(fullVarName);
+    }
+}
+
+template <typename T>
+void followInputDir(GDataConverter<T>& gdc)
+{
+    // Stop following on an interrupt or termination signal, once the 
+    // timestep being converted has been written
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = onStopSignal;
+    sa.sa_flags = SA_RESTART;
+    sigaction(SIGINT, &sa, 0);
+    sigaction(SIGTERM, &sa, 0);
+
+    // Timesteps are found by the files of the first field variable. Each 
+    // MPI rank converts every size-th timestep.
+    vector<GString> rootVarNames = gdc.fieldRootVarNames();
+    GString prefix = rootVarNames[0] + ".";
+    GString ext = G_FILE_EXT;
+    GUINT rank = MPIUtil::rank();
+    GUINT size = MPIUtil::size();
+
+    // With num_timesteps, stop once this rank's timesteps below it are 
+    // converted
+    GUINT numTimesteps = gdc.numTimesteps();
+    GSIZET numLocalTimesteps = 0;
+    for (GUINT i = rank; i < numTimesteps; i += size)
+    {
+        ++numLocalTimesteps;
+    }
+
+    GDirWatcher watcher(gdc.inputDir(), gdc.followPollInterval());
+    set<GString> converted;
+    GDOUBLE lastConverted = Timer::getTime();
+    while (!stopFollowing)
+    {
+        // Find the timesteps in the input directory, in order
+        vector<GString> timesteps;
+        for (auto f : GDirWatcher::listFiles(gdc.inputDir()))
+        {
+            if (f.size() > prefix.size() + ext.size() &&
+                f.compare(0, prefix.size(), prefix) == 0 &&
+                f.compare(f.size() - ext.size(), ext.size(), ext) == 0)
+            {
+                timesteps.push_back(f.substr(prefix.size(), 
+                                    f.size() - prefix.size() - ext.size()));
+            }
         }
+        std::sort(timesteps.begin(), timesteps.end());
+
+        for (auto timestep : timesteps)
+        {
+            if (stopFollowing || converted.count(timestep) != 0 ||
+                timestep.find_first_not_of("0123456789") != string::npos)
+            {
+                continue;
+            }
+            GSIZET t = stoull(timestep);
+            if ((numTimesteps > 0 && t >= numTimesteps) || t % size != rank)
+            {
+                continue;
+            }
+
+            // Wait until every field variable file of the timestep has been 
+            // written in full
+            GBOOL complete = true;
+            for (auto rootVarName : rootVarNames)
+            {
+                complete = complete && gdc.isVariableFileComplete(
+                                rootVarName + "." + timestep + G_FILE_EXT);
+            }
+            if (!complete)
+            {
+                continue;
+            }
+
+            vector<GString> fullVarNames = gdc.addTimestep(timestep);
+            if (gdc.do_incremental())
+            {
+                fullVarNames = pendingFieldVariables(gdc, fullVarNames);
+            }
+            if (!fullVarNames.empty())
+            {
+                convertTimestep(gdc, timestep, fullVarNames);
+            }
+            converted.insert(timestep);
+            lastConverted = Timer::getTime();
+        }
+
+        if (numTimesteps > 0 && converted.size() == numLocalTimesteps)
+        {
+            Logger::print(GL_INFO, "Converted the timesteps below " \
+                          "num_timesteps (" + to_string(numTimesteps) + ")");
+            break;
+        }
+        if (gdc.followTimeout() > 0 && 
+            Timer::getTime() - lastConverted >= gdc.followTimeout())
+        {
+            Logger::print(GL_INFO, "No new timestep within follow_timeout, " \
+                          "stopping");
+            break;
+        }
+        watcher.wait();
     }
+}
 
-    return 0;
+void onStopSignal(int signal)
+{
+    (void)signal;
+    stopFollowing = 1;
+}
+
+template <typename T>
+GString outputFilename(const GDataConverter<T>& gdc,
+                       const GString& fullVarName)
+{
+    // A file per field variable, or a file per timestep with all the field 
+    // variables
+    if (gdc.do_write_separate_var_files())
+    {
+        return fullVarName + NC_FILE_EXT;
+    }
+    return "vars." + gdc.extractTimestep(fullVarName) + NC_FILE_EXT;
+}
+
+template <typename T>
+vector<GString> pendingFieldVariables(const GDataConverter<T>& gdc,
+                                      const vector<GString>& fullVarNames)
+{
+    // Group the field variables by the output file they are written to
+    map<GString, vector<GString>> outputVarNames;
+    for (auto fullVarName : fullVarNames)
+    {
+        outputVarNames[outputFilename(gdc, fullVarName)].push_back(
+                                                                fullVarName);
+    }
+
+    // Drop the output files that are current at every level of detail, 
+    // and take a snapshot of the GeoFLOW files of the others before they 
+    // are read
+    GSIZET numOutputs = outputVarNames.size();
+    for (auto it = outputVarNames.begin(); it != outputVarNames.end(); )
+    {
+        vector<GString> sources;
+        for (auto fullVarName : it->second)
+        {
+            sources.push_back(fullVarName + G_FILE_EXT);
+        }
+
+        GBOOL isCurrent = true;
+        for (GSIZET l = 0; l < gdc.numLODLevels(); ++l)
+        {
+            isCurrent = isCurrent && 
+                        manifest.isCurrent(gdc.lodLevelDir(l) + it->first, 
+                                           sources);
+        }
+        if (isCurrent)
+        {
+            it = outputVarNames.erase(it);
+            continue;
+        }
+        for (GSIZET l = 0; l < gdc.numLODLevels(); ++l)
+        {
+            manifest.stage(gdc.lodLevelDir(l) + it->first, sources);
+        }
+        ++it;
+    }
+
+    Logger::print(GL_INFO, "Skipping " + 
+                  to_string(numOutputs - outputVarNames.size()) + " of " + 
+                  to_string(numOutputs) + " output files that are current");
+
+    // Keep the variables of the remaining output files, in their original 
+    // order
+    vector<GString> names;
+    for (auto fullVarName : fullVarNames)
+    {
+        if (outputVarNames.count(outputFilename(gdc, fullVarName)) != 0)
+        {
+            names.push_back(fullVarName);
+        }
+    }
+    return names;
+}
+
+template <typename T>
+void writeProfileReport(const GDataConverter<T>& gdc)
+{
+    // Each MPI rank writes its own report
+    GString filename = gdc.outputDir() + "/profile";
+    if (MPIUtil::size() > 1)
+    {
+        filename += "." + to_string(MPIUtil::rank());
+    }
+    filename += ".json";
+
+    map<GString, GString> info;
+    info["json_file"] = jsonFile;
+    info["rank"] = to_string(MPIUtil::rank());
+    info["num_ranks"] = to_string(MPIUtil::size());
+    info["num_nodes"] = to_string(gdc.nodes().size());
+    info["num_field_variables"] = to_string(gdc.fieldVarNames().size());
+    prof.writeReport(filename, info);
 }
 
 void parseCommandLine(int argc, char** argv)
@@ -246,6 +765,12 @@ void parseCommandLine(int argc, char** argv)
     {
         jsonFile = argv[1];
     }
+    else if (argc == 3 && (GString(argv[1]) == "--validate" || 
+                           GString(argv[1]) == "--inspect"))
+    {
+        checkMode = argv[1];
+        jsonFile = argv[2];
+    }
     else
     {
         GString progName(argv[0]);
@@ -255,12 +780,13 @@ void parseCommandLine(int argc, char** argv)
         exit(EXIT_FAILURE);
     }
 
-    cout << "Using JSON file: " << jsonFile << endl;
+    Logger::print(GL_INFO, "Using JSON file: " + jsonFile);
 }
 
 void usage(char programName[])
 {
     GString progName(programName);
-    GString msg = "Usage: " + progName + " <JSON_FILENAME>";
+    GString msg = "Usage: " + progName + " [--validate | --inspect] " \
+                  "<JSON_FILENAME>";
     Logger::error(__FILE__, __FUNCTION__, msg);
 }
\ No newline at end of file
@@ -76,4 +76,44 @@ array<T, 3> MathUtil::xyzToLatLonRadius(array<T, 3> pos)
     ll[1] = toDegrees(ll[1]);
    
     return array<T, 3> {ll[0], ll[1], r};
+}
+
+template <typename T>
+GSIZET MathUtil::xyzToLatLonRadius(GSIZET n, 
+                                   const T* __restrict__ x, 
+                                   const T* __restrict__ y, 
+                                   const T* __restrict__ z,
+                                   T* __restrict__ lat, 
+                                   T* __restrict__ lon, 
+                                   T* __restrict__ rad)
+{
+    // Compute radius and count coordinates that cannot be normalized. The 
+    // normalized x,y are kept in lat,lon until the next pass.
+    GSIZET nZeros = 0;
+    for (GSIZET i = 0; i < n; ++i)
+    {
+        rad[i] = sqrt((x[i] * x[i]) + (y[i] * y[i]) + (z[i] * z[i]));
+        lat[i] = x[i] / rad[i];
+        lon[i] = y[i] / rad[i];
+        nZeros += (rad[i] == T(0));
+    }
+
+    // Get lat,lon of each normalized coordinate
+    T nx, ny;
+    for (GSIZET i = 0; i < n; ++i)
+    {
+        nx = lat[i];
+        ny = lon[i];
+        lat[i] = asin(z[i] / rad[i]);
+        lon[i] = atan2(ny, nx);
+    }
+
+    // Convert to degrees
+    for (GSIZET i = 0; i < n; ++i)
+    {
+        lat[i] = lat[i] * (180.0 / M_PI);
+        lon[i] = lon[i] * (180.0 / M_PI);
+    }
+
+    return nZeros;
 }
\ No newline at end of file
@@ -0,0 +1,250 @@
+//==============================================================================
+// Date        : 10/16/26 (agent)
+// Description : Compares a NetCDF file written by the converter with an
+//               expected one: the same dimensions (names and sizes), the same
+//               variables (names, types and dimensions) and the same values,
+//               to within a relative tolerance. With --slice, the actual file
+//               is compared with a hyperslab of the expected file along one
+//               dimension (e.g., the mesh layers kept by a subset).
+//               Attributes are not compared. Exits with a nonzero status if
+//               the files differ.
+// Copyright   : Copyright 2021. Regents of the University of Colorado.
+//               All rights reserved.
+//==============================================================================
+
+#include <iostream>
+#include <vector>
+#include <map>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <netcdf>
+
+#include "gtypes.h"
+
+using namespace std;
+using namespace netCDF;
+
+// Options of the comparison
+struct CompareOptions
+{
+    GString expected;   // expected NetCDF file
+    GString actual;     // NetCDF file to check
+    GDOUBLE tolerance;  // max difference relative to the larger value
+    GString sliceDim;   // dim the expected file is sliced along ("" if none)
+    GSIZET sliceStart;  // first index of the slice
+    GSIZET sliceCount;  // num indices of the slice
+};
+
+void usage(const char* prog)
+{
+    cerr << "Usage: " << prog << " [options] <EXPECTED_NC> <ACTUAL_NC>\n"
+         << "  --tolerance <t>               max difference relative to the "
+            "larger value\n"
+         << "                                (default 1e-12)\n"
+         << "  --slice <dim> <start> <count> compare with indices "
+            "[start, start + count)\n"
+         << "                                of dim <dim> of the expected "
+            "file"
+         << endl;
+}
+
+CompareOptions parseCommandLine(int argc, char** argv)
+{
+    CompareOptions o = {"", "", 1e-12, "", 0, 0};
+    vector<GString> files;
+    for (int i = 1; i < argc; ++i)
+    {
+        GString arg = argv[i];
+        if (arg == "--tolerance" && i + 1 < argc)
+        {
+            o.tolerance = atof(argv[++i]);
+        }
+        else if (arg == "--slice" && i + 3 < argc)
+        {
+            o.sliceDim = argv[++i];
+            o.sliceStart = strtoull(argv[++i], NULL, 10);
+            o.sliceCount = strtoull(argv[++i], NULL, 10);
+        }
+        else if (arg[0] == '-')
+        {
+            usage(argv[0]);
+            exit(EXIT_FAILURE);
+        }
+        else
+        {
+            files.push_back(arg);
+        }
+    }
+
+    if (files.size() != 2)
+    {
+        usage(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    o.expected = files[0];
+    o.actual = files[1];
+    return o;
+}
+
+// Report a difference between the files and count it
+void report(GSIZET& nDiffs, const GString& msg)
+{
+    if (nDiffs < 10) { cerr << "  " << msg << endl; }
+    ++nDiffs;
+}
+
+// Size of a dim of the expected file once sliced
+GSIZET slicedSize(const CompareOptions& o, const NcDim& dim)
+{
+    return (dim.getName() == o.sliceDim) ? o.sliceCount : dim.getSize();
+}
+
+/*!
+ * Compare the values of a variable in both files.
+ *
+ * @param o options of the comparison
+ * @param e the variable in the expected file
+ * @param a the variable in the actual file
+ * @param nDiffs num differences found (incremented)
+ */
+void compareValues(const CompareOptions& o, const NcVar& e, const NcVar& a,
+                   GSIZET& nDiffs)
+{
+    vector<NcDim> dims = e.getDims();
+    vector<size_t> start(dims.size(), 0);
+    vector<size_t> count(dims.size());
+    GSIZET n = 1;
+    for (GSIZET i = 0; i < dims.size(); ++i)
+    {
+        if (dims[i].getName() == o.sliceDim) { start[i] = o.sliceStart; }
+        count[i] = slicedSize(o, dims[i]);
+        n *= count[i];
+    }
+    if (n == 0) { return; }
+
+    vector<GDOUBLE> eValues(n);
+    vector<GDOUBLE> aValues(n);
+    e.getVar(start, count, eValues.data());
+    a.getVar(aValues.data());
+
+    GSIZET nVarDiffs = 0;
+    GDOUBLE maxDiff = 0;
+    GSIZET first = 0;
+    for (GSIZET i = 0; i < n; ++i)
+    {
+        GDOUBLE diff = fabs(eValues[i] - aValues[i]);
+        GDOUBLE scale = max(1.0, max(fabs(eValues[i]), fabs(aValues[i])));
+        if (diff <= o.tolerance * scale) { continue; }
+        if (nVarDiffs == 0) { first = i; }
+        maxDiff = max(maxDiff, diff);
+        ++nVarDiffs;
+    }
+
+    if (nVarDiffs > 0)
+    {
+        report(nDiffs, e.getName() + ": " + to_string(nVarDiffs) + " of " +
+               to_string(n) + " values differ (first at " + to_string(first) +
+               ", max difference " + to_string(maxDiff) + ")");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    CompareOptions o = parseCommandLine(argc, argv);
+    GSIZET nDiffs = 0;
+
+    try
+    {
+        NcFile expected(o.expected, NcFile::read);
+        NcFile actual(o.actual, NcFile::read);
+
+        // Dims
+        multimap<GString, NcDim> eDims = expected.getDims();
+        multimap<GString, NcDim> aDims = actual.getDims();
+        for (auto& d : eDims)
+        {
+            auto it = aDims.find(d.first);
+            if (it == aDims.end())
+            {
+                report(nDiffs, "missing dim " + d.first);
+            }
+            else if (it->second.getSize() != slicedSize(o, d.second))
+            {
+                report(nDiffs, "dim " + d.first + " has size " +
+                       to_string(it->second.getSize()) + " instead of " +
+                       to_string(slicedSize(o, d.second)));
+            }
+        }
+        for (auto& d : aDims)
+        {
+            if (eDims.find(d.first) == eDims.end())
+            {
+                report(nDiffs, "unexpected dim " + d.first);
+            }
+        }
+
+        // Vars
+        multimap<GString, NcVar> eVars = expected.getVars();
+        multimap<GString, NcVar> aVars = actual.getVars();
+        for (auto& v : eVars)
+        {
+            auto it = aVars.find(v.first);
+            if (it == aVars.end())
+            {
+                report(nDiffs, "missing var " + v.first);
+                continue;
+            }
+
+            const NcVar& e = v.second;
+            const NcVar& a = it->second;
+            GString eType = e.getType().getName();
+            if (a.getType().getName() != eType)
+            {
+                report(nDiffs, "var " + v.first + " has type " +
+                       a.getType().getName() + " instead of " + eType);
+                continue;
+            }
+
+            vector<NcDim> eVarDims = e.getDims();
+            vector<NcDim> aVarDims = a.getDims();
+            GBOOL sameDims = (eVarDims.size() == aVarDims.size());
+            for (GSIZET i = 0; sameDims && i < eVarDims.size(); ++i)
+            {
+                sameDims = (eVarDims[i].getName() == aVarDims[i].getName() &&
+                            slicedSize(o, eVarDims[i]) ==
+                            aVarDims[i].getSize());
+            }
+            if (!sameDims)
+            {
+                report(nDiffs, "var " + v.first + " has different dims");
+                continue;
+            }
+
+            // Only numeric values are compared
+            if (eType == "char" || eType == "string") { continue; }
+            compareValues(o, e, a, nDiffs);
+        }
+        for (auto& v : aVars)
+        {
+            if (eVars.find(v.first) == eVars.end())
+            {
+                report(nDiffs, "unexpected var " + v.first);
+            }
+        }
+    }
+    catch (exceptions::NcException& e)
+    {
+        cerr << "Error: Cannot compare " << o.actual << " with " << o.expected
+             << ": " << e.what() << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    if (nDiffs > 0)
+    {
+        cerr << "FAIL " << o.actual << " (" << nDiffs << " differences with "
+             << o.expected << ")" << endl;
+        exit(EXIT_FAILURE);
+    }
+    return 0;
+}
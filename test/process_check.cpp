@@ -0,0 +1,51 @@
+//==============================================================================
+// Date        : 10/16/26 (agent)
+// Description : Runs tasks in forked child processes with
+//               ProcessUtil::runInProcesses while the Logger's writer thread
+//               is running in the parent. With "fail", the first task ends
+//               through the usual Logger::error and exit(EXIT_FAILURE) path,
+//               which must end the child cleanly so the parent reports the
+//               failed child and exits with EXIT_FAILURE. With "pass", every
+//               task succeeds and the program exits with EXIT_SUCCESS.
+// Copyright   : Copyright 2021. Regents of the University of Colorado.
+//               All rights reserved.
+//==============================================================================
+
+#include <iostream>
+#include <vector>
+#include <functional>
+#include <cstdlib>
+
+#include "gtypes.h"
+#include "logger.h"
+#include "process_util.h"
+
+using namespace std;
+
+int main(int argc, char** argv)
+{
+    GString mode = (argc == 2) ? argv[1] : "";
+    if (mode != "pass" && mode != "fail")
+    {
+        cerr << "Usage: " << argv[0] << " <pass|fail>" << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    // Start the writer thread, as the converter has by the time it forks
+    Logger::warning(__FILE__, __FUNCTION__, "Running 2 tasks in 2 processes");
+
+    vector<std::function<void()>> tasks;
+    tasks.push_back([&mode]
+    {
+        if (mode == "fail")
+        {
+            Logger::error(__FILE__, __FUNCTION__, "Task 0 failed.");
+            exit(EXIT_FAILURE);
+        }
+    });
+    tasks.push_back([] {});
+
+    ProcessUtil::runInProcesses(tasks, 2);
+    Logger::warning(__FILE__, __FUNCTION__, "Every task succeeded");
+    return 0;
+}
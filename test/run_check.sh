@@ -0,0 +1,163 @@
+#!/bin/bash
+#==============================================================================
+# Date        : 10/16/26 (agent)
+# Description : Converts the test datasets in test-data with bin/main and
+#               compares the NetCDF files with the expected ones in
+#               test-data/expected-output-data-* using bin/nc_compare. The 3D
+#               dataset is also converted with the optional modes (streaming,
+#               reordering, concurrent reads and writes, grid cache, subset,
+#               level of detail and incremental conversion), and --validate is
+#               run on both datasets and on a truncated copy of the 3D one.
+#               bin/process_check checks that a task that fails in a forked
+#               child process ends the child cleanly.
+#               Usage: test/run_check.sh
+#               Set CHECK_DIR to choose where outputs are written (default
+#               check-data) and CHECK_TOLERANCE to set the relative tolerance
+#               of the comparisons (default 1e-12).
+# Copyright   : Copyright 2021. Regents of the University of Colorado.
+#               All rights reserved.
+#==============================================================================
+
+CHECK_DIR=${CHECK_DIR:-check-data}
+CHECK_TOLERANCE=${CHECK_TOLERANCE:-1e-12}
+
+nFailed=0
+rm -rf "$CHECK_DIR"
+mkdir -p "$CHECK_DIR"
+
+# Print the result of a check and count it if it failed
+# $1 = name of the check, $2 = status of the check (0 if passed)
+result() {
+    if [ "$2" -eq 0 ]; then
+        echo "PASS $1"
+    else
+        echo "FAIL $1"
+        nFailed=$((nFailed + 1))
+    fi
+}
+
+# Write a copy of a JSON file with another output directory and more keys
+# $1 = JSON file, $2 = copy, $3 = output directory, $4 = keys to add
+make_json() {
+    sed -e "s|\"output_dir\": *\"[^\"]*\"|\"output_dir\": \"$3\"|" "$1" > "$2"
+    if [ -n "$4" ]; then
+        sed -i "0,/{/s//{\n    $4,/" "$2"
+    fi
+}
+
+# Convert a dataset into $CHECK_DIR/<name> (the log goes to <name>.log)
+# $1 = name, $2 = JSON file, $3 = keys to add to the JSON file
+convert() {
+    local out="$CHECK_DIR/$1"
+    rm -rf "$out"
+    make_json "$2" "$CHECK_DIR/$1.json" "$out" "$3"
+    ./bin/main "$CHECK_DIR/$1.json" > "$CHECK_DIR/$1.log" 2>&1
+}
+
+# Compare every NetCDF file of a directory with the one of the same name in
+# another directory
+# $1 = directory of expected files, $2 = directory of actual files, $3... =
+# more nc_compare options
+compare_dir() {
+    local expected=$1 actual=$2 status=0 f
+    shift 2
+    for f in "$expected"/*.nc; do
+        ./bin/nc_compare --tolerance "$CHECK_TOLERANCE" "$@" \
+            "$f" "$actual/$(basename "$f")" || status=1
+    done
+    return $status
+}
+
+# Convert a dataset and compare its files with the expected ones
+# $1 = name, $2 = JSON file, $3 = directory of expected files, $4 = keys
+check_convert() {
+    convert "$1" "$2" "$4" && compare_dir "$3" "$CHECK_DIR/$1"
+    result "$1" $?
+}
+
+JSON_3D=test-data/ugrid-3D.json
+JSON_BOX=test-data/ugrid-box.json
+EXPECTED_3D=test-data/expected-output-data-3D
+EXPECTED_BOX=test-data/expected-output-data-box
+
+# Default conversions
+check_convert 3D $JSON_3D $EXPECTED_3D
+check_convert box $JSON_BOX $EXPECTED_BOX
+
+# Modes that must not change the output
+check_convert 3D-stream $JSON_3D $EXPECTED_3D '"stream_timesteps": true'
+check_convert 3D-reorder $JSON_3D $EXPECTED_3D \
+    '"reorder_by_permutation": true'
+check_convert 3D-threads $JSON_3D $EXPECTED_3D \
+    '"use_mmap_reader": true, "num_read_threads": 4'
+check_convert 3D-writers $JSON_3D $EXPECTED_3D \
+    '"num_writer_processes": 2, "layers_per_write": 3'
+check_convert box-stream $JSON_BOX $EXPECTED_BOX \
+    '"stream_timesteps": true, "reorder_by_permutation": true'
+
+# Grid cache: the second run reads the grid work from grid.cache
+check_convert 3D-cache $JSON_3D $EXPECTED_3D '"use_grid_cache": true'
+out="$CHECK_DIR/3D-cache"
+./bin/main "$CHECK_DIR/3D-cache.json" > "$CHECK_DIR/3D-cache-2.log" 2>&1 &&
+    [ -f "$out/grid.cache" ] && compare_dir $EXPECTED_3D "$out"
+result 3D-cache-rerun $?
+
+# Subset of the second element layer: its mesh layers of the expected files
+nZ=5 # num 2D mesh layers per element layer (poly order 4)
+convert 3D-subset $JSON_3D '"subset": {"element_layers": [1]}' &&
+    compare_dir $EXPECTED_3D "$CHECK_DIR/3D-subset" --slice meshLayers $nZ $nZ
+result 3D-subset $?
+
+# Level of detail: the full resolution files are unchanged and each pyramid
+# level matches a conversion at that stride
+check_convert 3D-lod-pyramid $JSON_3D $EXPECTED_3D '"lod_pyramid": [2]'
+convert 3D-lod2 $JSON_3D '"lod_stride": 2' &&
+    compare_dir "$CHECK_DIR/3D-lod2" "$CHECK_DIR/3D-lod-pyramid/lod2"
+result 3D-lod-pyramid-level $?
+
+# Incremental: a rerun writes no file, and a deleted file is written again
+check_convert 3D-incremental $JSON_3D $EXPECTED_3D '"incremental": true'
+out="$CHECK_DIR/3D-incremental"
+touch "$CHECK_DIR/3D-incremental.marker"
+./bin/main "$CHECK_DIR/3D-incremental.json" > \
+    "$CHECK_DIR/3D-incremental-2.log" 2>&1 &&
+    [ -z "$(find "$out" -name '*.nc' -newer \
+            "$CHECK_DIR/3D-incremental.marker")" ]
+result 3D-incremental-skip $?
+rm -f "$out/v2.000001.nc"
+./bin/main "$CHECK_DIR/3D-incremental.json" > \
+    "$CHECK_DIR/3D-incremental-3.log" 2>&1 &&
+    compare_dir $EXPECTED_3D "$out"
+result 3D-incremental-redo $?
+
+# Validation: both datasets pass, and a truncated file is an error
+for name in 3D box; do
+    ./bin/main --validate test-data/ugrid-$name.json > \
+        "$CHECK_DIR/validate-$name.log" 2>&1
+    result validate-$name $?
+done
+cp -r test-data/input-data-3D "$CHECK_DIR/input-data-truncated"
+f="$CHECK_DIR/input-data-truncated/v1.000001.out"
+truncate -s $(($(stat -c %s "$f") - 8)) "$f"
+sed -e "s|\"input_dir\": *\"[^\"]*\"|\"input_dir\": \"${f%/*}\"|" $JSON_3D > \
+    "$CHECK_DIR/validate-truncated.json"
+! ./bin/main --validate "$CHECK_DIR/validate-truncated.json" > \
+    "$CHECK_DIR/validate-truncated.log" 2>&1
+result validate-truncated $?
+
+# Child processes: a task that fails through Logger::error and exit ends its
+# child cleanly (no abort), and the parent reports it and fails
+./bin/process_check pass > "$CHECK_DIR/process-pass.log" 2>&1
+result process-pass $?
+./bin/process_check fail > "$CHECK_DIR/process-fail.log" 2>&1
+[ $? -eq 1 ] &&
+    grep -q "1 child process(es) failed" "$CHECK_DIR/process-fail.log" &&
+    ! grep -q "terminate\|signal" "$CHECK_DIR/process-fail.log"
+result process-fail $?
+
+if [ $nFailed -ne 0 ]; then
+    echo "$nFailed checks failed (outputs and logs are in $CHECK_DIR)"
+    exit 1
+fi
+echo "All checks passed"
+rm -rf "$CHECK_DIR"